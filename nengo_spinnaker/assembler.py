@@ -144,6 +144,7 @@ class MulticastPlayer(utils.vertices.NengoVertex):
             c.post_obj for c in assembler.get_outgoing_connections(mcp))
 
         start_items = list()
+        timed_packets = list()
         end_items = list()
 
         for sink in sinks:
@@ -152,19 +153,36 @@ class MulticastPlayer(utils.vertices.NengoVertex):
                                     0 if p.payload is None else p.payload,
                                     p.payload is not None])
 
+            # Packets scheduled during the simulation, played back against
+            # their timestamps (in ticks) by the mc_player
+            for p in getattr(sink, 'timed_packets', []):
+                timed_packets.append(p)
+
             for p in sink.end_packets:
                 end_items.extend([0, p.key,
                                   0 if p.payload is None else p.payload,
                                   p.payload is not None])
 
+        # The mc_player streams the timed packets in order, so sort them
+        # by timestamp
+        timed_items = list()
+        for p in sorted(timed_packets, key=lambda p: p.timestamp):
+            timed_items.extend([p.timestamp, p.key,
+                                0 if p.payload is None else p.payload,
+                                p.payload is not None])
+
         # Build the regions
         start_items.insert(0, len(start_items)/4)
         start_region = utils.vertices.UnpartitionedListRegion(
             start_items)
+        timed_items.insert(0, len(timed_items)/4)
+        timed_region = utils.vertices.UnpartitionedListRegion(
+            timed_items)
         end_items.insert(0, len(end_items)/4)
         end_region = utils.vertices.UnpartitionedListRegion(
             end_items)
         mcp.regions[1] = start_region
+        mcp.regions[2] = timed_region
         mcp.regions[3] = end_region
 
         return mcp
@@ -55,8 +55,6 @@ def build_ensembles(objects, connections, probes, dt, rng):
                     new_obj.record_spikes = True
                     new_obj.probes.append(p)
                 elif p.attr == 'voltage':
-                    raise NotImplementedError("Voltage probing not currently "
-                                              "supported.")
                     new_obj.record_voltage = True
                     new_obj.probes.append(p)
 
@@ -273,12 +271,14 @@ class EnsembleLIF(utils.vertices.NengoVertex):
     MODEL_NAME = 'nengo_ensemble'
     MAX_ATOMS = 128
     spikes_recording_region = 15
+    voltage_recording_region = 16
 
     def __init__(self, n_neurons, system_region, bias_region, encoders_region,
                  decoders_region, output_keys_region, input_filter_region,
                  input_filter_routing, inhib_filter_region,
                  inhib_filter_routing, gain_region, modulatory_filter_region,
-                 modulatory_filter_routing, pes_region, spikes_region):
+                 modulatory_filter_routing, pes_region, spikes_region,
+                 voltage_region):
         super(EnsembleLIF, self).__init__(n_neurons)
 
         # Create regions
@@ -297,6 +297,7 @@ class EnsembleLIF(utils.vertices.NengoVertex):
         self.regions[11] = modulatory_filter_routing
         self.regions[12] = pes_region
         self.regions[14] = spikes_region
+        self.regions[15] = voltage_region
         self.probes = list()
 
     @classmethod
@@ -309,8 +310,11 @@ class EnsembleLIF(utils.vertices.NengoVertex):
             assembler.timestep,
             int(ens.tau_ref / (assembler.timestep * 10**-6)),
             utils.fp.bitsk(assembler.dt / ens.tau_rc),
-            0x1 if ens.record_spikes else 0x0,
-            1
+            0x2 if ens.record_spikes else 0x0,  # Spike recording format
+            1,
+            0x0,  # Flags (see region_system_t in ensemble.h)
+            0x0,  # Shared input SysRAM tag (multi-core ensembles only)
+            0x1 if ens.record_voltage else 0x0,  # Voltage recording
         ]
 
         # Prepare the input filtering regions
@@ -370,14 +374,16 @@ class EnsembleLIF(utils.vertices.NengoVertex):
         gain_region = utils.vertices.MatrixRegionPartitionedByRows(
             ens.gains, formatter=utils.fp.bitsk)
         pes_region = utils.vertices.UnpartitionedListRegion(pes_items)
-        spikes_region = utils.vertices.BitfieldBasedRecordingRegion(
+        spikes_region = utils.vertices.CompressedSpikeRecordingRegion(
             assembler.n_ticks)
+        voltage_region = utils.vertices.PartitionedValueRecordingRegion(
+            assembler.n_ticks) if ens.record_voltage else None
 
         vertex = cls(ens.n_neurons, system_region, bias_region,
                      encoders_region, decoders_region, output_keys_region,
                      input_filter_region, input_filter_routing,
                      inhib_filter_region, inhib_filter_routing, gain_region,
                      modul_filter_region, modul_filter_routing,
-                     pes_region, spikes_region)
+                     pes_region, spikes_region, voltage_region)
         vertex.probes = ens.probes
         return vertex
@@ -74,17 +74,28 @@ class IntermediateFilter(object):
 
 
 class FilterVertex(utils.vertices.NengoVertex):
+    """Applies a transform to its filtered input and transmits the result.
+
+    The output dimensions are the vertex's atoms: a transform too large
+    for one core's tick budget is partitioned by rows across several
+    cores, each loading its row slice of the transform and output keys
+    while sharing the full input filter configuration.
+    """
     MODEL_NAME = 'nengo_filter'
-    MAX_ATOMS = 1
+    MAX_ATOMS = 64
 
     def __init__(self, size_in, in_connections, dt, output_period=100,
-                 interpacket_pause=1):
+                 interpacket_pause=1, transmit_epsilon=0., refresh_interval=10):
         super(FilterVertex, self).__init__(1)
         self.size_in = size_in
 
-        # Create the system region
+        # Create the system region.  Dimensions which have not moved by
+        # more than the epsilon since last sent are skipped, with a full
+        # refresh every refresh_interval transmissions (see filter.h).
         system_region = utils.vertices.UnpartitionedListRegion([
-            size_in, None, 1000, output_period, interpacket_pause])
+            size_in, None, 1000, output_period, interpacket_pause,
+            utils.fp.bitsk(transmit_epsilon), refresh_interval],
+            n_atoms_index=1)
 
         # Create the filter regions
         (in_filters, in_routing, _) = utils.vertices.make_filter_regions(
@@ -93,13 +104,15 @@ class FilterVertex(utils.vertices.NengoVertex):
 
     @classmethod
     def get_output_keys_region(cls, fv, assembler):
+        # Keep the keyspaces unresolved so each subvertex's keys carry
+        # its own index in the `c` field
         output_keys = list()
 
         for c in assembler.get_outgoing_connections(fv):
             for d in range(c.width):
-                output_keys.append(c.keyspace.key(d=d))
+                output_keys.append(c.keyspace(d=d))
 
-        return utils.vertices.UnpartitionedListRegion(output_keys)
+        return utils.vertices.PartitionedKeysRegion(output_keys)
 
     @classmethod
     def get_transform(cls, fv, assembler):
@@ -111,7 +124,7 @@ class FilterVertex(utils.vertices.NengoVertex):
             assert tf.function is None
 
         transforms = np.vstack(t.transform for t in conns.transforms_functions)
-        transform_region = utils.vertices.UnpartitionedMatrixRegion(
+        transform_region = utils.vertices.MatrixRegionPartitionedByRows(
             transforms, formatter=utils.fp.bitsk)
 
         return transforms.shape[0], transform_region
@@ -121,9 +134,11 @@ class FilterVertex(utils.vertices.NengoVertex):
         if len(assembler.get_outgoing_connections(fv)) == 0:
             return None
         # Create the output keys region and add it to the instance, then
-        # return.
+        # return.  The output dimensions are the atoms over which the
+        # vertex is partitioned.
         fv.regions[0].data[1], fv.regions[4] = cls.get_transform(fv, assembler)
         fv.regions[1] = cls.get_output_keys_region(fv, assembler)
+        fv.n_atoms = fv.regions[0].data[1]
         return fv
 
     @classmethod
@@ -139,6 +154,7 @@ class FilterVertex(utils.vertices.NengoVertex):
         fv_.regions[1] = cls.get_output_keys_region(fv, assembler)
         fv_.regions[0].data[1], fv_.regions[4] =\
             cls.get_transform(fv, assembler)
+        fv_.n_atoms = fv_.regions[0].data[1]
 
         return fv_
 
@@ -170,8 +186,9 @@ class ValueSource(utils.vertices.NengoVertex):
         data = np.array(data)
         data.shape = (1, data.size)
 
-        # Calculate the number of blocks
-        frames_per_block = 5*1024/conns.width
+        # Calculate the number of blocks: each block must fill one slot of
+        # the value source's 4-slot 20KB ring (see slots.h)
+        frames_per_block = 5*1024/4/conns.width
         full_blocks = int(duration / dt) / frames_per_block
         partial_block = int(duration / dt) % frames_per_block
 
@@ -173,6 +173,9 @@ class Simulator(object):
                         if p.attr == 'spikes':
                             self.probes.append(
                                 utils.probes.SpikeProbe(vertex, p))
+                        elif p.attr == 'voltage':
+                            self.probes.append(
+                                utils.probes.VoltageProbe(vertex, p))
 
         # PACMANify!
         for vertex in vertices:
@@ -42,8 +42,16 @@ class TransformFunctionCollection(object):
 
 
 class SDPRxVertex(utils.vertices.NengoVertex):
+    """Plays externally supplied values into the machine.
+
+    One vertex may represent more dimensions than fit on a single core:
+    the dimensions are the vertex's atoms, so PACMAN shards a wide input
+    into per-core (offset, count) slices, each with its own slice of the
+    output keys.  The host addresses each subvertex with its slice of
+    the data (see sdp_tx_tick).
+    """
     MODEL_NAME = 'nengo_rx'
-    MAX_ATOMS = 1
+    MAX_ATOMS = 64
 
     def __init__(self):
         super(SDPRxVertex, self).__init__(1)
@@ -53,17 +61,31 @@ class SDPRxVertex(utils.vertices.NengoVertex):
         self.regions = list()
 
     @property
-    def remaining_dims(self):
-        return 64 - sum(
+    def n_assigned_dims(self):
+        return sum(
             [c.transform.shape[0] for c in self.transforms_functions])
 
+    @property
+    def remaining_dims(self):
+        return self.MAX_DIMS - self.n_assigned_dims
+
+    # Dimensions an SDPRxVertex may carry before a further vertex is
+    # created; each block of MAX_ATOMS is placed on its own core
+    MAX_DIMS = 256
+
     @classmethod
     def assemble(cls, rx, assembler):
-        # Create the regions and monkey-patch them into the SDPRxVertex
-        system_items = [1000, 64-rx.remaining_dims]
-        system_region = utils.vertices.UnpartitionedListRegion(system_items)
-        output_keys_region =\
-            utils.vertices.UnpartitionedListRegion(rx.output_keys)
+        # Partition the dimensions across cores
+        rx.n_atoms = rx.n_assigned_dims
+
+        # Create the regions and monkey-patch them into the SDPRxVertex.
+        # Each core receives its dimension count and slice offset, and
+        # the matching rows of the output keys.
+        system_items = [1000, rx.n_assigned_dims, 0]
+        system_region = utils.vertices.UnpartitionedListRegion(
+            system_items, n_atoms_index=1, lo_atom_index=2)
+        output_keys_region = utils.vertices.MatrixRegionPartitionedByRows(
+            np.array(rx.output_keys, dtype=np.uint32))
 
         rx.regions.extend([system_region, output_keys_region])
 
@@ -118,6 +140,9 @@ class Ethernet(object):
         self.rx_fresh = dict()
         self.rx_buffers = collections.defaultdict(list)
 
+        # Map Rx --> last transmitted frame (for delta encoding)
+        self.rx_last = dict()
+
     @property
     def io(self):
         return self
@@ -263,16 +288,49 @@ class Ethernet(object):
         # mark as stale.
         for rx in self.rx_elements:
             if self.rx_fresh[rx]:
-                xyp = rx.subvertices[0].placement.processor.get_coordinates()
-
                 with self.output_lock:
                     data = fp.bitsk(np.hstack(self.rx_buffers[rx]))
                     self.rx_fresh[rx] = False
 
-                data = struct.pack("H14x%dI" % len(data), 1, *data)
-                packet = sdp.SDPMessage(dst_x=xyp[0], dst_y=xyp[1],
-                                        dst_cpu=xyp[2], data=data)
-                self.out_socket.sendto(str(packet), (self.machinename, 17893))
+                # Compute the changed dimensions (global indices), used
+                # when a deltas message is cheaper than a full frame
+                last = self.rx_last.get(rx)
+                self.rx_last[rx] = data
+                if last is not None and len(last) == len(data):
+                    deltas = [(d, v) for (d, v) in enumerate(data)
+                              if v != last[d]]
+                    if len(deltas) == 0:
+                        continue
+                else:
+                    deltas = None
+
+                # Address each subvertex with its own dimension slice
+                # (cmd_rc selects the format, see sdp-rx.h)
+                for sv in rx.subvertices:
+                    xyp = sv.placement.processor.get_coordinates()
+                    (lo, hi) = (sv.lo_atom, sv.hi_atom)
+
+                    if deltas is not None:
+                        sv_deltas = [(d - lo, v) for (d, v) in deltas
+                                     if lo <= d <= hi]
+                        if len(sv_deltas) == 0:
+                            continue
+                    else:
+                        sv_deltas = None
+
+                    sv_data = data[lo:hi + 1]
+                    if (sv_deltas is not None and
+                            2 * len(sv_deltas) < len(sv_data)):
+                        pairs = [w for delta in sv_deltas for w in delta]
+                        payload = struct.pack("H2xI8x%dI" % len(pairs),
+                                              2, len(sv_deltas), *pairs)
+                    else:
+                        payload = struct.pack("H14x%dI" % len(sv_data),
+                                              1, *sv_data)
+                    packet = sdp.SDPMessage(dst_x=xyp[0], dst_y=xyp[1],
+                                            dst_cpu=xyp[2], data=payload)
+                    self.out_socket.sendto(str(packet),
+                                           (self.machinename, 17893))
 
         # Reschedule the Tx tick
         if not self.stop_now:
@@ -1,6 +1,5 @@
 import numpy as np
 import logging
-import warnings
 logger = logging.getLogger(__name__)
 
 import nengo
@@ -49,59 +48,92 @@ class DecodedValueProbe(SpiNNakerProbe):
                              self.recording_vertex.width))
 
 
-try:
-    from bitarray import bitarray
+class VoltageProbe(SpiNNakerProbe):
+    def __init__(self, target_vertex, probe):
+        super(VoltageProbe, self).__init__(probe)
+        self.target_vertex = target_vertex
 
-    class SpikeProbe(SpiNNakerProbe):
-        def __init__(self, target_vertex, probe):
-            super(SpikeProbe, self).__init__(probe)
-            self.target_vertex = target_vertex
-
-        def get_data(self, txrx):
-            # Calculate the number of frames
-            n_frames = int(self.target_vertex.runtime * 1000)  # TODO Neaten!
-            data = [list() for n in range(n_frames)]
-
-            for subvertex in self.target_vertex.subvertices:
-                # Get the contents of the "SPIKES" region for each subvertex
-                (x, y, p) = subvertex.placement.processor.get_coordinates()
-
-                size = self.target_vertex.regions[
-                    self.target_vertex.spikes_recording_region-1].sizeof(
-                        subvertex.lo_atom, subvertex.hi_atom)
-
-                sdata = vertices.retrieve_region_data(
-                    txrx, x, y, p, self.target_vertex.spikes_recording_region,
-                    size)
+    def get_data(self, txrx):
+        # One value frame per recorded tick per subvertex (see recording.h)
+        region = self.target_vertex.regions[
+            self.target_vertex.voltage_recording_region - 1]
+        n_frames = (region.n_ticks + region.decimation - 1) //\
+            region.decimation
+        data = np.zeros((n_frames, self.probe.target.n_neurons))
 
-                # Cast the spikes as a bit array
-                spikes = bitarray()
-                spikes.frombytes(sdata)
+        for subvertex in self.target_vertex.subvertices:
+            (x, y, p) = subvertex.placement.processor.get_coordinates()
 
-                # Convert each frame into a list of spiked neurons
-                frame_length = ((subvertex.n_atoms >> 5) +
-                                (1 if subvertex.n_atoms & 0x1f else 0))
+            size = region.sizeof(subvertex.lo_atom, subvertex.hi_atom)
+            sdata = vertices.retrieve_region_data(
+                txrx, x, y, p, self.target_vertex.voltage_recording_region,
+                size)
 
-                for f in range(n_frames-1):  # TODO Understand the -1
-                    frame = spikes[32*f*frame_length + 32:
-                                   32*(f + 1)*frame_length + 32]
-                    data[f].extend([n + subvertex.lo_atom for n in
-                                    range(subvertex.n_atoms) if frame[n]])
+            values = np.array(fp.kbits(
+                [int(i) for i in np.fromstring(sdata, dtype=np.uint32)]))
+            data[:, subvertex.lo_atom:subvertex.hi_atom + 1] =\
+                values.reshape((n_frames, subvertex.n_atoms))
 
-            # Convert into list of spike times
-            spikes = [[0.] for n in range(self.probe.target.n_neurons)]
-            for (i, f) in enumerate(data):
-                for n in f:
-                    spikes[n].append(i*self.dt)
+        return data
 
-            return spikes
 
-except ImportError:
-    # No bitarray, so no spike probing!
-    warnings.warn("Cannot import module bitarray: spike probing is disabled",
-                  ImportWarning)
+class SpikeProbe(SpiNNakerProbe):
+    def __init__(self, target_vertex, probe):
+        super(SpikeProbe, self).__init__(probe)
+        self.target_vertex = target_vertex
 
-    class SpikeProbe(object):
-        def __init__(self, *args, **kwargs):
-            raise NotImplementedError("Spike probing requires the module "
-                                      "'bitarray' to be installed.")
+    def get_data(self, txrx):
+        # Calculate the number of frames
+        n_frames = int(self.target_vertex.runtime * 1000)  # TODO Neaten!
+        data = [list() for n in range(n_frames)]
+
+        for subvertex in self.target_vertex.subvertices:
+            # Get the contents of the "SPIKES" region for each subvertex
+            (x, y, p) = subvertex.placement.processor.get_coordinates()
+
+            size = self.target_vertex.regions[
+                self.target_vertex.spikes_recording_region-1].sizeof(
+                    subvertex.lo_atom, subvertex.hi_atom)
+
+            sdata = vertices.retrieve_region_data(
+                txrx, x, y, p, self.target_vertex.spikes_recording_region,
+                size)
+
+            # Decode the spike-index frames (see recording.h): the region
+            # holds a word count, then one frame per tick consisting of a
+            # header word followed by either packed 16-bit neuron indices
+            # or (flagged by the top bit) a bitmap.
+            words = np.fromstring(sdata, dtype=np.uint32)
+            frame_length = ((subvertex.n_atoms >> 5) +
+                            (1 if subvertex.n_atoms & 0x1f else 0))
+
+            n_words = int(words[0])
+            pos = 1
+            f = 0
+            while pos < 1 + n_words and f < n_frames:
+                header = int(words[pos])
+                pos += 1
+
+                if header & 0x80000000:
+                    # Bitmap fallback frame
+                    neurons = [n for n in range(subvertex.n_atoms)
+                               if (words[pos + (n >> 5)] >> (n & 0x1f)) & 0x1]
+                    pos += frame_length
+                else:
+                    neurons = []
+                    for i in range(header):
+                        word = int(words[pos + (i >> 1)])
+                        neurons.append((word >> 16) if i & 0x1
+                                       else (word & 0xffff))
+                    pos += (header + 1) >> 1
+
+                data[f].extend(n + subvertex.lo_atom for n in neurons)
+                f += 1
+
+        # Convert into list of spike times
+        spikes = [[0.] for n in range(self.probe.target.n_neurons)]
+        for (i, f) in enumerate(data):
+            for n in f:
+                spikes[n].append(i*self.dt)
+
+        return spikes
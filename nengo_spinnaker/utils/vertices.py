@@ -93,7 +93,8 @@ class NengoVertex(graph.Vertex):
             # write the region
             if size > 0 and not region.unfilled:
                 spec.switchWriteFocus(i)
-                if isinstance(region, UnpartitionedKeysRegion):
+                if isinstance(region, (UnpartitionedKeysRegion,
+                                       PartitionedKeysRegion)):
                     index = self.subvertices.index(subvertex)
                     region.write_out(subvertex.lo_atom, subvertex.hi_atom,
                                      index, spec)
@@ -258,7 +259,7 @@ class UnpartitionedListRegion(object):
     """
     def __init__(self, data=None, prepend_length=False, size=None,
                  in_dtcm=True, unfilled=False, n_atoms_index=None,
-                 dtype='uint32'):
+                 lo_atom_index=None, dtype='uint32'):
         if data is None:
             size = 0
         if data is not None and size is None:
@@ -271,6 +272,7 @@ class UnpartitionedListRegion(object):
         self.unfilled = unfilled
         self.prepend_length = prepend_length
         self.n_atoms_index = n_atoms_index
+        self.lo_atom_index = lo_atom_index
 
     def sizeof(self, lo_atom, hi_atom):
         return self.size + (1 if self.prepend_length else 0)
@@ -282,6 +284,8 @@ class UnpartitionedListRegion(object):
         for i, data in enumerate(self.data):
             if self.n_atoms_index is not None and self.n_atoms_index == i:
                 spec.write(data=hi_atom-lo_atom+1, sizeof=self.dtype)
+            elif self.lo_atom_index is not None and self.lo_atom_index == i:
+                spec.write(data=lo_atom, sizeof=self.dtype)
             else:
                 spec.write(data=data, sizeof=self.dtype)
 
@@ -300,6 +304,42 @@ class BitfieldBasedRecordingRegion(object):
         return frame_size * self.n_ticks
 
 
+class CompressedSpikeRecordingRegion(object):
+    """A region holding spike-index recording frames (see recording.h).
+
+    Sized for the worst case: a length word, then one header word plus a
+    bitmap fallback frame per tick.
+    """
+    def __init__(self, n_ticks):
+        self.n_ticks = n_ticks
+        self.in_dtcm = False
+        self.unfilled = True
+
+    def sizeof(self, lo_atom, hi_atom):
+        n_atoms = hi_atom - lo_atom + 1
+        frame_size = (n_atoms >> 5) + (1 if n_atoms & 0x1f else 0)
+        return (frame_size + 1) * self.n_ticks + 1
+
+
+class PartitionedValueRecordingRegion(object):
+    """A region holding one value per atom per recorded tick.
+
+    Frames are written every `decimation` ticks (see RECORD_DECIMATE_* in
+    recording.h), so the region shrinks with the decimation factor.
+    """
+    in_dtcm = False
+    unfilled = True
+
+    def __init__(self, n_ticks, decimation=1):
+        self.n_ticks = n_ticks
+        self.decimation = decimation
+
+    def sizeof(self, lo_atom, hi_atom):
+        n_atoms = hi_atom - lo_atom + 1
+        n_frames = (self.n_ticks + self.decimation - 1) // self.decimation
+        return n_atoms * n_frames
+
+
 class FrameBasedRecordingRegion(object):
     in_dtcm = False
     unfilled = True
@@ -372,6 +412,27 @@ class UnpartitionedMatrixRegion(object):
         spec.write_array(final_data)
 
 
+class PartitionedKeysRegion(object):
+    """A region of one output key per atom, partitioned with the vertex.
+
+    Holds keyspaces rather than resolved keys so that each subvertex's
+    keys can carry its own index in the `c` field, matching the routing
+    keys generated for its outgoing subedges.
+    """
+    in_dtcm = True
+    unfilled = False
+
+    def __init__(self, keyspaces):
+        self.keyspaces = keyspaces
+
+    def sizeof(self, lo_atom, hi_atom):
+        return hi_atom - lo_atom + 1
+
+    def write_out(self, lo_atom, hi_atom, index, spec):
+        for ks in self.keyspaces[lo_atom:hi_atom + 1]:
+            spec.write(data=ks.key(c=index))
+
+
 class UnpartitionedKeysRegion(object):
     in_dtcm = True
     unfilled = False
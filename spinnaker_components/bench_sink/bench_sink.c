@@ -0,0 +1,112 @@
+#include "bench_sink.h"
+
+system_parameters_t pars;  // Global system parameters
+input_filter_t g_input;    // Filters the arriving packets feed
+
+uint packets_received;     // Packets which arrived
+uint packets_echoed;       // Payloads retransmitted on the echo key
+uint echo_failures;        // Echoes the router refused
+uint tick_arrivals;        // Arrivals so far this tick
+uint max_per_tick;         // Most arrivals in a single tick
+uint last_arrival;         // Timer 2 count at the previous arrival
+uint gap_min;              // Shortest inter-arrival gap / cycles
+uint gap_max;              // Longest inter-arrival gap / cycles
+unsigned long long gap_sum;  // Total inter-arrival cycles
+
+hot_fn void mcpl_rx(uint key, uint payload) {
+  // Timestamp the arrival; Timer 2 counts down
+  uint now = tc[T2_COUNT];
+  if (packets_received > 0) {
+    uint gap = last_arrival - now;
+    if (packets_received == 1 || gap < gap_min) {
+      gap_min = gap;
+    }
+    if (gap > gap_max) {
+      gap_max = gap;
+    }
+    gap_sum += gap;
+  }
+  last_arrival = now;
+  packets_received++;
+  tick_arrivals++;
+
+  if (pars.echo_key != 0) {
+    if (spin1_send_mc_packet(pars.echo_key, payload, WITH_PAYLOAD)) {
+      packets_echoed++;
+    } else {
+      echo_failures++;
+    }
+  }
+
+  input_filter_mcpl_rx(&g_input, key, payload);
+}
+
+void finalise(void) {
+  bench_sink_results_t *results = sark_xalloc(
+    sv->sysram_heap, sizeof(bench_sink_results_t), 0, ALLOC_LOCK);
+  if (results == NULL) {
+    io_printf(IO_BUF, "[Bench Sink] Failed to claim SysRAM for results.\n");
+    return;
+  }
+
+  results->packets_received = packets_received;
+  results->packets_echoed = packets_echoed;
+  results->echo_failures = echo_failures;
+  results->max_per_tick = max_per_tick;
+  results->gap_min = gap_min;
+  results->gap_max = gap_max;
+  results->gap_mean = (packets_received > 1) ?
+    (uint) (gap_sum / (packets_received - 1)) : 0;
+  sark.vcpu->user1 = (uint) results;
+
+  io_printf(IO_BUF, "[Bench Sink] Received %u (max %u per tick), echoed %u "
+            "(%u failures), gap min %u, max %u, mean %u cycles\n",
+            packets_received, max_per_tick, packets_echoed, echo_failures,
+            results->gap_min, results->gap_max, results->gap_mean);
+}
+
+void bench_sink_tick(uint ticks, uint arg1) {
+  use(arg1);
+  if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    finalise();
+    spin1_exit(0);
+    return;
+  }
+
+  if (tick_arrivals > max_per_tick) {
+    max_per_tick = tick_arrivals;
+  }
+  tick_arrivals = 0;
+
+  // Run the same filtering step as the real components
+  input_filter_step(&g_input, true);
+}
+
+void c_main(void) {
+  address_t address = system_load_sram();
+  spin1_memcpy(&pars, region_start(1, address), sizeof(system_parameters_t));
+  io_printf(IO_BUF, "[Bench Sink] %d dimensions, echo key %08x\n",
+            pars.n_dimensions, pars.echo_key);
+
+  if (input_filter_initialise(&g_input, pars.n_dimensions) == NULL ||
+      !input_filter_get_filters(&g_input, region_start(2, address)) ||
+      !input_filter_get_filter_routes(&g_input, region_start(3, address))
+  ) {
+    io_printf(IO_BUF, "[Bench Sink] Failed to initialise.\n");
+    return;
+  }
+
+  if (leadAp) {
+    system_lead_app_configured();
+  }
+
+  // Run Timer 2 as a free-running down counter for the arrival stamps
+  tc[T2_LOAD] = 0xFFFFFFFF;
+  tc[T2_CONTROL] = 0x82;
+
+  // Set up callbacks, start
+  spin1_set_timer_tick(pars.timestep);
+  spin1_callback_on(MCPL_PACKET_RECEIVED, mcpl_rx, -1);
+  spin1_callback_on(TIMER_TICK, bench_sink_tick, 2);
+  spin1_start(SYNC_WAIT);
+}
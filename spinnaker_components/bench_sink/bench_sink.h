@@ -0,0 +1,49 @@
+/*!\addtogroup BENCH_SINK
+ * \brief MC packet sink and echo for on-hardware benchmarks.
+ *
+ * The sink counts arriving packets and timestamps each arrival with the
+ * free-running hardware timer (Timer 2), accumulating inter-arrival
+ * statistics.  When an echo key is configured every payload is
+ * retransmitted on that key, so a bench_source routed through this core
+ * measures round-trip latency.  Packets are also pushed through a
+ * standard input filter collection so the benchmark exercises the same
+ * routing and filtering path as the real components.  Results are
+ * written to SysRAM at the end of the simulation and the address
+ * published in vcpu->user1.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#ifndef __BENCH_SINK_H__
+#define __BENCH_SINK_H__
+
+#include "spin1_api.h"
+#include "common-impl.h"
+#include "nengo-common.h"
+
+#include "input_filter.h"
+
+typedef struct _system_parameters_t {
+  uint timestep;      //!< Time step / us
+  uint n_dimensions;  //!< Number of input dimensions
+  uint echo_key;      //!< Key to echo payloads with (0 = no echo)
+} system_parameters_t;
+
+/*! \brief Results block read back by the host.
+ */
+typedef struct _bench_sink_results_t {
+  uint packets_received;  //!< Packets which arrived
+  uint packets_echoed;    //!< Payloads retransmitted on the echo key
+  uint echo_failures;     //!< Echoes the router refused
+  uint max_per_tick;      //!< Most arrivals in a single tick
+  uint gap_min;           //!< Shortest inter-arrival gap / cycles
+  uint gap_max;           //!< Longest inter-arrival gap / cycles
+  uint gap_mean;          //!< Mean inter-arrival gap / cycles
+} bench_sink_results_t;
+
+#endif
+
+/*! @} */
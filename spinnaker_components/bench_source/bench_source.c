@@ -0,0 +1,106 @@
+#include "bench_source.h"
+
+system_parameters_t pars;  // Global system parameters
+uint *keys;                // Transmit keys
+uint next_key;             // Next key index to transmit with
+
+uint packets_sent;         // Packets transmitted so far
+uint echoes_received;      // Echoed packets received back
+uint latency_min;          // Shortest round trip / cycles
+uint latency_max;          // Longest round trip / cycles
+unsigned long long latency_sum;  // Total round-trip cycles
+
+hot_fn void mcpl_rx(uint key, uint payload) {
+  use(key);
+
+  // The payload is the Timer 2 count at transmission; Timer 2 counts down
+  uint cycles = payload - tc[T2_COUNT];
+
+  if (echoes_received == 0 || cycles < latency_min) {
+    latency_min = cycles;
+  }
+  if (cycles > latency_max) {
+    latency_max = cycles;
+  }
+  latency_sum += cycles;
+  echoes_received++;
+}
+
+void finalise(void) {
+  bench_source_results_t *results = sark_xalloc(
+    sv->sysram_heap, sizeof(bench_source_results_t), 0, ALLOC_LOCK);
+  if (results == NULL) {
+    io_printf(IO_BUF, "[Bench Source] Failed to claim SysRAM for results.\n");
+    return;
+  }
+
+  results->packets_sent = packets_sent;
+  results->echoes_received = echoes_received;
+  results->latency_min = latency_min;
+  results->latency_max = latency_max;
+  results->latency_mean = (echoes_received > 0) ?
+    (uint) (latency_sum / echoes_received) : 0;
+  sark.vcpu->user1 = (uint) results;
+
+  io_printf(IO_BUF, "[Bench Source] Sent %u, echoed %u, latency min %u, "
+            "max %u, mean %u cycles\n", packets_sent, echoes_received,
+            results->latency_min, results->latency_max,
+            results->latency_mean);
+}
+
+void bench_source_tick(uint ticks, uint arg1) {
+  use(arg1);
+  if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    finalise();
+    spin1_exit(0);
+    return;
+  }
+
+  // Transmit the configured load, cycling through the keys
+  for (uint p = 0; p < pars.packets_per_tick; p++) {
+    spin1_send_mc_packet(keys[next_key], tc[T2_COUNT], WITH_PAYLOAD);
+    packets_sent++;
+
+    next_key++;
+    if (next_key == pars.n_keys) {
+      next_key = 0;
+    }
+  }
+}
+
+bool data_get_keys(address_t addr) {
+  MALLOC_FAIL_FALSE(keys, pars.n_keys * sizeof(uint));
+  spin1_memcpy(keys, addr, pars.n_keys * sizeof(uint));
+
+  for (uint i = 0; i < pars.n_keys; i++) {
+    io_printf(IO_BUF, "keys[%d] = %08x\n", i, keys[i]);
+  }
+
+  return true;
+}
+
+void c_main(void) {
+  address_t address = system_load_sram();
+  spin1_memcpy(&pars, region_start(1, address), sizeof(system_parameters_t));
+  io_printf(IO_BUF, "[Bench Source] %d keys, %d packets per tick\n",
+            pars.n_keys, pars.packets_per_tick);
+
+  if (!data_get_keys(region_start(2, address))) {
+    io_printf(IO_BUF, "[Bench Source] Failed to initialise.\n");
+    return;
+  }
+
+  if (leadAp) {
+    system_lead_app_configured();
+  }
+
+  // Run Timer 2 as a free-running down counter for the latency stamps
+  tc[T2_LOAD] = 0xFFFFFFFF;
+  tc[T2_CONTROL] = 0x82;
+
+  // Set up callbacks, start
+  spin1_set_timer_tick(pars.timestep);
+  spin1_callback_on(MCPL_PACKET_RECEIVED, mcpl_rx, -1);
+  spin1_callback_on(TIMER_TICK, bench_source_tick, 2);
+  spin1_start(SYNC_WAIT);
+}
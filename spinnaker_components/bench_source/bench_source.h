@@ -0,0 +1,44 @@
+/*!\addtogroup BENCH_SOURCE
+ * \brief Configurable MC packet load generator for on-hardware benchmarks.
+ *
+ * Each timer tick the source transmits a configurable number of packets,
+ * cycling through a list of keys loaded from SDRAM.  Every payload is
+ * the current value of the free-running hardware timer (Timer 2), so a
+ * route which echoes the packets back to this core yields a round-trip
+ * latency sample measured entirely against this core's own clock.
+ * Min/max/mean latency and the packet counts are written to SysRAM when
+ * the simulation finishes and the address published in vcpu->user1, in
+ * the manner of the profiler results.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#ifndef __BENCH_SOURCE_H__
+#define __BENCH_SOURCE_H__
+
+#include "spin1_api.h"
+#include "common-impl.h"
+#include "nengo-common.h"
+
+typedef struct _system_parameters_t {
+  uint timestep;          //!< Time step / us
+  uint n_keys;            //!< Number of transmit keys
+  uint packets_per_tick;  //!< Packets to transmit each tick
+} system_parameters_t;
+
+/*! \brief Results block read back by the host.
+ */
+typedef struct _bench_source_results_t {
+  uint packets_sent;      //!< Packets transmitted
+  uint echoes_received;   //!< Echoed packets received back
+  uint latency_min;       //!< Shortest round trip / cycles
+  uint latency_max;       //!< Longest round trip / cycles
+  uint latency_mean;      //!< Mean round trip / cycles
+} bench_source_results_t;
+
+#endif
+
+/*! @} */
@@ -45,8 +45,27 @@ typedef struct filtered_input_buffer {
 
   value_t filter;       //!< Filter value, e.g., \f$\exp(-\frac{dt}{\tau})\f$
   value_t n_filter;     //!< 1 - filter value
+
+  //! Step kernel for this buffer, selected by input_buffer_select_step
+  void (*step)(struct filtered_input_buffer *buffer);
+
+  /* Activity tracking.  A buffer which is receiving no packets and whose
+   * filtered values have decayed to (effectively) zero is marked dormant
+   * and its step skipped entirely until the next packet arrives; sparse,
+   * phasic models leave most filters in this state almost all the time.
+   * Buffers with a retaining accumulator mask are never dormant, as the
+   * held accumulator feeds the filter on every tick.
+   */
+  bool active_input;    //!< A packet has arrived since the last step
+  bool dormant;         //!< Quiescent: filtered is zero and input silent
 } filtered_input_buffer_t;
 
+//! Magnitude below which a draining filter is treated as zero
+#define INPUT_BUFFER_QUIET_EPSILON kbits(0x10)
+
+// Forward declaration, see the step kernels below
+static inline void input_buffer_step_generic(filtered_input_buffer_t *buffer);
+
 //! Create and initialise an input buffer, and zero the accumulator
 static inline filtered_input_buffer_t* input_buffer_initialise( uint d_in ) {
   // Create the buffer on the heap
@@ -64,11 +83,29 @@ static inline filtered_input_buffer_t* input_buffer_initialise( uint d_in ) {
     buffer->filtered[d] = 0.0k;
   }
 
+  // Default step kernel; input_buffer_select_step may specialise it once
+  // the accumulator mask is known
+  buffer->step = input_buffer_step_generic;
+
+  // Dormant until the first packet arrives
+  buffer->active_input = false;
+  buffer->dormant = true;
+
   return buffer;
 }
 
-//! Filter an input buffer and zero the accumulator
-static inline void input_buffer_step( filtered_input_buffer_t *buffer ) {
+/* Step kernels **************************************************************
+ *
+ * The filter step runs on every core on every tick, so specialised kernels
+ * are provided for the common cases: an always-clear accumulator mask
+ * (which drops the kbits/bitsk masking from the loop) and unrolled
+ * variants for the dimension counts which dominate our models.  The
+ * appropriate kernel is selected once, when the filter parameters are
+ * loaded, and called through buffer->step thereafter.
+ */
+
+//! Generic kernel: any dimensionality, any accumulator mask
+static inline void input_buffer_step_generic(filtered_input_buffer_t *buffer) {
   // For each input dimension perform filtering and zero the accumulator
   for( uint d = 0; d < buffer->d_in; d++ ){
     // Perform the filtering
@@ -81,10 +118,120 @@ static inline void input_buffer_step( filtered_input_buffer_t *buffer ) {
   }
 }
 
+//! Any dimensionality, always-clear accumulator mask
+static inline void input_buffer_step_clear(filtered_input_buffer_t *buffer) {
+  value_t *filtered = buffer->filtered;
+  value_t *accumulator = buffer->accumulator;
+  const value_t filter = buffer->filter;
+  const value_t n_filter = buffer->n_filter;
+
+  for (uint d = 0; d < buffer->d_in; d++) {
+    filtered[d] = filtered[d] * filter + accumulator[d] * n_filter;
+    accumulator[d] = 0.0k;
+  }
+}
+
+//! One dimension, always-clear accumulator mask
+static inline void input_buffer_step_clear_d1(filtered_input_buffer_t *buffer) {
+  buffer->filtered[0] = buffer->filtered[0] * buffer->filter +
+                        buffer->accumulator[0] * buffer->n_filter;
+  buffer->accumulator[0] = 0.0k;
+}
+
+//! Two dimensions, always-clear accumulator mask
+static inline void input_buffer_step_clear_d2(filtered_input_buffer_t *buffer) {
+  const value_t filter = buffer->filter;
+  const value_t n_filter = buffer->n_filter;
+
+  buffer->filtered[0] = buffer->filtered[0] * filter +
+                        buffer->accumulator[0] * n_filter;
+  buffer->filtered[1] = buffer->filtered[1] * filter +
+                        buffer->accumulator[1] * n_filter;
+  buffer->accumulator[0] = 0.0k;
+  buffer->accumulator[1] = 0.0k;
+}
+
+//! Multiple-of-four dimensions, always-clear accumulator mask
+static inline void input_buffer_step_clear_d4n(filtered_input_buffer_t *buffer) {
+  value_t *filtered = buffer->filtered;
+  value_t *accumulator = buffer->accumulator;
+  const value_t filter = buffer->filter;
+  const value_t n_filter = buffer->n_filter;
+
+  for (uint d = 0; d < buffer->d_in; d += 4) {
+    filtered[d]     = filtered[d]     * filter + accumulator[d]     * n_filter;
+    filtered[d + 1] = filtered[d + 1] * filter + accumulator[d + 1] * n_filter;
+    filtered[d + 2] = filtered[d + 2] * filter + accumulator[d + 2] * n_filter;
+    filtered[d + 3] = filtered[d + 3] * filter + accumulator[d + 3] * n_filter;
+    accumulator[d] = 0.0k;
+    accumulator[d + 1] = 0.0k;
+    accumulator[d + 2] = 0.0k;
+    accumulator[d + 3] = 0.0k;
+  }
+}
+
+//! Select the step kernel appropriate to a buffer's dimensions and mask.
+//! Call once the mask has been loaded.
+static inline void input_buffer_select_step(filtered_input_buffer_t *buffer) {
+  if (buffer->mask != 0x00000000) {
+    buffer->step = input_buffer_step_generic;
+  } else if (buffer->d_in == 1) {
+    buffer->step = input_buffer_step_clear_d1;
+  } else if (buffer->d_in == 2) {
+    buffer->step = input_buffer_step_clear_d2;
+  } else if (buffer->d_in % 4 == 0) {
+    buffer->step = input_buffer_step_clear_d4n;
+  } else {
+    buffer->step = input_buffer_step_clear;
+  }
+}
+
+//! Filter an input buffer and clear or retain the accumulator, skipping
+//! the work entirely while the buffer is dormant
+static inline void input_buffer_step( filtered_input_buffer_t *buffer ) {
+  if (buffer->dormant) {
+    if (!buffer->active_input) {
+      return;
+    }
+    buffer->dormant = false;
+  }
+
+  /* Clear the arrival flag before running the kernel: a packet landing
+   * at any later point sets it again and so survives into the next step,
+   * whatever happens below.
+   */
+  bool had_input = buffer->active_input;
+  buffer->active_input = false;
+
+  buffer->step(buffer);
+
+  if (!had_input && buffer->mask == 0x00000000) {
+    // Draining: drop to dormant once everything has decayed away
+    value_t max = 0.0k;
+    for (uint d = 0; d < buffer->d_in; d++) {
+      value_t v = buffer->filtered[d];
+      if (v < 0.0k) {
+        v = -v;
+      }
+      if (v > max) {
+        max = v;
+      }
+    }
+
+    if (max <= INPUT_BUFFER_QUIET_EPSILON && !buffer->active_input) {
+      for (uint d = 0; d < buffer->d_in; d++) {
+        buffer->filtered[d] = 0.0k;
+      }
+      buffer->dormant = true;
+    }
+  }
+}
+
 //! Apply the given input to a dimension of the input buffer
 static inline void input_buffer_acc(filtered_input_buffer_t *b, uint d,
     value_t v) {
   b->accumulator[d] = kbits(bitsk(b->accumulator[d]) & b->mask_) + v;
+  b->active_input = true;
 }
 
 #endif
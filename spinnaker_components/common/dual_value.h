@@ -0,0 +1,48 @@
+/*!\addtogroup DUAL_VALUE
+ * \brief Packing of two adjacent dimensions into one MC packet payload.
+ *
+ * Represented values fit comfortably in s7.8, so a pair of adjacent
+ * dimensions may share a 32-bit payload as two 16-bit fixed point halves,
+ * halving the packet count of a connection.  The sender packs dimensions
+ * (d, d+1) under the key of dimension d; a receiving route marked as
+ * packed (top bit of its filter word) unpacks the payload into the two
+ * corresponding accumulator dimensions.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+#include "stdfix-full-iso.h"
+#include "nengo_typedefs.h"
+
+#ifndef __DUAL_VALUE_H__
+#define __DUAL_VALUE_H__
+
+//! Top bit of a route's filter word marks its payloads as packed
+#define DUAL_VALUE_ROUTE_FLAG 0x80000000
+
+//! Pack two s16.15 values into one payload as two s7.8 halves
+static inline uint dual_value_pack(value_t low, value_t high) {
+  uint l = ((uint) bitsk(low) >> 7) & 0xffff;
+  uint h = ((uint) bitsk(high) >> 7) & 0xffff;
+  return (h << 16) | l;
+}
+
+//! Unpack the low (even dimension) half of a payload
+static inline value_t dual_value_unpack_low(uint payload) {
+  int v = ((int) (payload << 16)) >> 16;  // Sign extend the low half
+  return kbits(v << 7);
+}
+
+//! Unpack the high (odd dimension) half of a payload
+static inline value_t dual_value_unpack_high(uint payload) {
+  int v = ((int) payload) >> 16;  // Sign extend the high half
+  return kbits(v << 7);
+}
+
+#endif
+
+/*! @} */
@@ -0,0 +1,42 @@
+#include "init_dma.h"
+
+//! Largest single transfer the DMA controller accepts / bytes
+#define INIT_DMA_CHUNK 0x8000
+
+static bool transfer_active = false;  //!< A transfer has been started
+
+static void start_transfer(void *dtcm, void *sdram, uint bytes) {
+  dma[DMA_ADRS] = (uint) sdram;
+  dma[DMA_ADRT] = (uint) dtcm;
+  // Word-width read from the system bus, burst of 16
+  dma[DMA_DESC] = (4 << 21) | bytes;
+  transfer_active = true;
+}
+
+void init_dma_copy(void *dtcm, void *sdram, uint bytes) {
+  // Transfers larger than the controller maximum are split, waiting
+  // between chunks; only the final chunk is left outstanding
+  while (bytes > INIT_DMA_CHUNK) {
+    init_dma_barrier();
+    start_transfer(dtcm, sdram, INIT_DMA_CHUNK);
+    dtcm = (uchar *) dtcm + INIT_DMA_CHUNK;
+    sdram = (uchar *) sdram + INIT_DMA_CHUNK;
+    bytes -= INIT_DMA_CHUNK;
+  }
+
+  if (bytes > 0) {
+    init_dma_barrier();
+    start_transfer(dtcm, sdram, bytes);
+  }
+}
+
+void init_dma_barrier(void) {
+  if (transfer_active) {
+    // Poll for transfer done, then clear it
+    while (!(dma[DMA_STAT] & 0x400)) {
+      continue;
+    }
+    dma[DMA_CTRL] = 0x8;
+    transfer_active = false;
+  }
+}
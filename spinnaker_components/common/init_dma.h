@@ -0,0 +1,40 @@
+/*!\addtogroup INIT_DMA
+ * \brief Overlapped SDRAM reads for region loading at start up.
+ *
+ * c_main loads its regions before spin1_start, when interrupts are
+ * disabled and spin1_dma_transfer completions cannot be serviced, so the
+ * large copies (encoders, decoders, biases) have been synchronous
+ * spin1_memcpy word loops.  These helpers instead drive the DMA
+ * controller directly: init_dma_copy starts a background transfer and
+ * returns, letting the CPU parse the small regions while the copy
+ * proceeds; a subsequent copy or init_dma_barrier polls the controller
+ * until the outstanding transfer has finished.  Call init_dma_barrier
+ * before spin1_start.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+#include "common-typedefs.h"
+
+#ifndef __INIT_DMA_H__
+#define __INIT_DMA_H__
+
+/*! \brief Copy a region from SDRAM into DTCM in the background.
+ *
+ * Waits for any previous init_dma_copy to finish, then starts the new
+ * transfer and returns immediately.  Addresses and length must be word
+ * aligned.  Only for use before spin1_start.
+ */
+void init_dma_copy(void *dtcm, void *sdram, uint bytes);
+
+/*! \brief Wait until the outstanding init_dma_copy (if any) has finished.
+ */
+void init_dma_barrier(void);
+
+#endif
+
+/*! @} */
@@ -20,9 +20,20 @@ value_t* input_filter_initialise(input_filter_t* input,
   return input->input;
 }
 
+value_t* input_filter_initialise_with_accumulator(input_filter_t* input,
+                                                  uint n_input_dimensions,
+                                                  value_t* accumulator)
+{
+  // Accumulate directly into a buffer owned by the caller (e.g. the
+  // payload of a pre-built SDP message)
+  input->n_dimensions = n_input_dimensions;
+  input->input = accumulator;
+  return input->input;
+}
+
 
 // Filter initialisation
-bool input_filter_get_filters(input_filter_t* input, address_t filter_region) {
+cold_fn bool input_filter_get_filters(input_filter_t* input, address_t filter_region) {
   input->n_filters = filter_region[0];
 
   io_printf(IO_BUF, "[Filters] n_filters = %d, n_input_dimensions = %d\n",
@@ -41,6 +52,7 @@ bool input_filter_get_filters(input_filter_t* input, address_t filter_region) {
       input->filters[f]->n_filter = filters[f].filter_;
       input->filters[f]->mask = filters[f].mask;
       input->filters[f]->mask_ = ~filters[f].mask;
+      input_buffer_select_step(input->filters[f]);
 
       io_printf(IO_BUF, "Filter [%u] = %k/%k Masked: 0x%08x/0x%08x Dimensions:%u\n",
                 f, filters[f].filter, filters[f].filter_, filters[f].mask,
@@ -73,12 +85,14 @@ bool input_filter_get_filter_routes(input_filter_t* input,
     }
   }
 
-  return true;
+  // Build the indexed key lookup over the routes
+  input_filter_t *inputs[1] = { input };
+  return routing_index_build(&input->index, inputs, 1);
 }
 
 
 // Input step
-void input_filter_step(input_filter_t* input, bool allocate_accumulator) {
+hot_fn void input_filter_step(input_filter_t* input, bool allocate_accumulator) {
   // Zero the input accumulator
   if(allocate_accumulator)
   {
@@ -94,9 +108,10 @@ void input_filter_step(input_filter_t* input, bool allocate_accumulator) {
     // Apply filtering
     input_buffer_step(input->filters[f]);
 
-    // If required, accumulate the value in 
-    // The global input accumulator.
-    if(allocate_accumulator)
+    // If required, accumulate the value in
+    // The global input accumulator.  A dormant filter contributes zero,
+    // so its accumulation is skipped along with its step.
+    if(allocate_accumulator && !input->filters[f]->dormant)
     {
       for (uint d = 0; d < input->n_dimensions; d++)
       {
@@ -109,18 +124,9 @@ void input_filter_step(input_filter_t* input, bool allocate_accumulator) {
 // Incoming spike callback
 bool input_filter_mcpl_rx(input_filter_t* input, uint key, uint payload) {
   /*
-   * 1. Look up key in input routing table entry
+   * 1. Look up key in the routing index
    * 2. Select appropriate filter
    * 3. Add value (payload) to appropriate dimension of given filter.
    */
-  // Compare against each key, value pair held in the input
-  for (uint i = 0; i < input->n_routes; i++) {
-    if ((key & input->routes[i].mask ) == input->routes[i].key) {
-      input_buffer_acc(input->filters[input->routes[i].filter],
-                       key & input->routes[i].dimension_mask,
-                       kbits(payload));
-      return true;
-    }
-  }
-  return false;
+  return routing_index_mcpl_rx(&input->index, key, payload);
 }
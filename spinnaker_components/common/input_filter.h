@@ -14,6 +14,7 @@
 #include "nengo-common.h"
 
 #include "dimensional-io.h"
+#include "routing_index.h"
 
 #ifndef __INPUT_FILTER_H__
 #define __INPUT_FILTER_H__
@@ -44,6 +45,8 @@ typedef struct _input_filter_t {
   input_filter_key_t *routes;        //!< List of keys, masks, filter IDs
   filtered_input_buffer_t **filters; //!< Filters to apply to the inputs
 
+  routing_index_t index;  //!< Indexed key lookup built over the routes
+
   value_t *input;     //!< Resultant input value
 } input_filter_t;
 
@@ -53,6 +56,14 @@ typedef struct _input_filter_t {
 value_t* input_filter_initialise(input_filter_t *input,
                                  uint n_input_dimensions);
 
+/*! \brief Initialise a input filter collection which accumulates into a
+ *  caller-owned buffer (e.g. the payload of a pre-built SDP message).
+ *  \returns Pointer to the filtered input vector
+ */
+value_t* input_filter_initialise_with_accumulator(input_filter_t *input,
+                                                  uint n_input_dimensions,
+                                                  value_t *accumulator);
+
 /*! \brief Initialise a input filter collection without allocating accumulator
  *  \returns Pointer to the filtered input vector
  */
@@ -2,6 +2,11 @@
  * \brief An input filter bank contains multiple input filters of differing
  *        dimensionality.
  *
+ * Packet dispatch uses one routing index merged over every input (see
+ * routing_index.h), so a packet resolves to its (input, filter,
+ * dimension) with a single lookup rather than a scan of each input's
+ * routes in turn.
+ *
  * \author Andrew Mundy <mundya@cs.man.ac.uk>
  * \copyright Advanced Processor Technologies, School of Computer Science, 
  *            University of Manchester
@@ -18,6 +23,8 @@
 typedef struct _input_filter_bank_t {
   uint n_inputs;            //!< Number of inputs
   input_filter_t* inputs;   //!< Pointer to array of inputs
+
+  routing_index_t index;    //!< Indexed key lookup merged over the inputs
 } input_filter_bank_t;
 
 /*! \brief Initialise an input filter bank.
@@ -44,7 +51,7 @@ bool input_filter_bank_get_routes(input_filter_bank_t *bank,
 
 /*! \brief Perform a step of filtering.
  */
-void input_filter_bank_step(input_filter_bank_t *bank);
+void input_filter_bank_step(input_filter_bank_t *bank, bool accumulate);
 
 /*! \brief Callback handler for an incoming dimensional MC packet.
  */
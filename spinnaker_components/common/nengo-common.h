@@ -1,24 +1,38 @@
 #ifndef __NENGO_COMMON_H__
 #define __NENGO_COMMON_H__
 
+#include "nengo_malloc.h"
+
+/* On SpiNNaker every APLX already executes from ITCM, so hot code cannot
+ * be moved to a faster memory; what can be controlled is layout.  hot_fn
+ * marks the per-tick and per-packet paths and cold_fn the one-shot
+ * initialisation code: GCC groups the cold functions away from the hot
+ * instruction stream and optimises them for size, keeping the tick loops
+ * dense and their branches well laid out.
+ */
+#define hot_fn __attribute__((hot))
+#define cold_fn __attribute__((cold))
+
 /** \def __MALLOC_FAIL
- * Will malloc \a SIZE and save the return pointer in \a VAR.  Should the
- * malloc fail \a DESC and an explanation will be stored in IO_BUF and
- * \a VAL will be returned on behalf of the calling function.
+ * Will malloc \a SIZE from the DTCM arena (see nengo_malloc.h) and save
+ * the return pointer in \a VAR.  Should the allocation fail \a DESC and
+ * an explanation will be stored in IO_BUF and \a VAL will be returned on
+ * behalf of the calling function.
  */
 #define __MALLOC_FAIL(VAR, SIZE, VAL) \
 do { \
   if ((SIZE) == 0) { \
     VAR = NULL; \
   } else { \
-    VAR = spin1_malloc(SIZE); \
+    VAR = nengo_malloc(SIZE); \
     if (VAR == NULL) { \
       io_printf(IO_BUF, "%s:%d Failed to malloc " #VAR " (%d bytes)\n", \
                 __FILE__, __LINE__, SIZE); \
       return VAL; \
     } else { \
-      io_printf(IO_BUF, "%s:%d Malloc " #VAR " (%d bytes)\n", \
-                __FILE__, __LINE__, SIZE); \
+      io_printf(IO_BUF, "%s:%d Malloc " #VAR " (%d bytes), arena %d/%d\n", \
+                __FILE__, __LINE__, SIZE, nengo_malloc_used(), \
+                nengo_malloc_total()); \
     } \
   } \
 } while (0)
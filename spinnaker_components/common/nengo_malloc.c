@@ -0,0 +1,56 @@
+#include "nengo_malloc.h"
+
+static uchar *arena_base = NULL;  //!< Start of the arena (NULL until reserved)
+static uint arena_size = 0;       //!< Size of the arena / bytes
+static uint arena_used = 0;       //!< Bytes handed out so far
+
+/* Reserve the remaining DTCM heap as one block, leaving a little behind
+ * for the API.  The heap's accounting excludes block headers, so back off
+ * in small steps until the allocation succeeds.
+ */
+static bool arena_reserve(void) {
+  uint size = sark.heap->free_bytes;
+  if (size <= NENGO_MALLOC_RESERVE) {
+    return false;
+  }
+  size -= NENGO_MALLOC_RESERVE;
+
+  while (size > 0 && (arena_base = spin1_malloc(size)) == NULL) {
+    size -= 32;
+  }
+  if (arena_base == NULL) {
+    return false;
+  }
+
+  arena_size = size;
+  arena_used = 0;
+  io_printf(IO_BUF, "[Malloc] Reserved %d byte DTCM arena.\n", arena_size);
+  return true;
+}
+
+void *nengo_malloc(uint size) {
+  if (arena_base == NULL && !arena_reserve()) {
+    return NULL;
+  }
+
+  // Keep every allocation word aligned
+  size = (size + 3) & ~0x3;
+
+  if (arena_used + size > arena_size) {
+    io_printf(IO_BUF, "[Malloc] Arena exhausted: %d bytes requested, "
+              "%d of %d used.\n", size, arena_used, arena_size);
+    return NULL;
+  }
+
+  void *block = arena_base + arena_used;
+  arena_used += size;
+  return block;
+}
+
+uint nengo_malloc_used(void) {
+  return arena_used;
+}
+
+uint nengo_malloc_total(void) {
+  return arena_size;
+}
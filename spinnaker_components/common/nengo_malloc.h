@@ -0,0 +1,49 @@
+/*!\addtogroup NENGO_MALLOC
+ * \brief DTCM arena allocation for the MALLOC_FAIL macros.
+ *
+ * Components allocate DTCM in dozens of small pieces at start up, which
+ * fragments the sark heap and can make a large late allocation (e.g. a
+ * decoder matrix) fail even though enough DTCM is free in total.  The
+ * arena instead reserves the remaining heap in one block on the first
+ * allocation and satisfies every subsequent request with a bump pointer,
+ * so allocation never fragments and its cost is a pointer increment.
+ * Nothing is ever freed: every allocation in this codebase lives for the
+ * duration of the simulation.
+ *
+ * The MALLOC_FAIL macros report the arena high-water mark with each
+ * allocation, so the IO_BUF log shows how close a core is to its DTCM
+ * ceiling and which subsystem consumed what.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+#include "common-typedefs.h"
+
+#ifndef __NENGO_MALLOC_H__
+#define __NENGO_MALLOC_H__
+
+/*! \brief Bytes of the sark heap left outside the arena for the API's
+ *         own use.
+ */
+#define NENGO_MALLOC_RESERVE 1024
+
+/*! \brief Allocate from the DTCM arena.
+ *
+ * The arena is reserved from the sark heap on the first call.  Returns
+ * NULL when the request is larger than the space remaining.
+ */
+void *nengo_malloc(uint size);
+
+//! Bytes allocated from the arena so far
+uint nengo_malloc_used(void);
+
+//! Total size of the arena / bytes
+uint nengo_malloc_total(void);
+
+#endif
+
+/*! @} */
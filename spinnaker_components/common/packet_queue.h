@@ -0,0 +1,93 @@
+/*!\addtogroup PACKET_QUEUE
+ * \brief A fixed-size lock-free ring buffer for deferring MC packet
+ *        processing out of interrupt context.
+ *
+ * The MCPL callback pushes raw (key, payload) pairs and returns
+ * immediately; routing and accumulation are performed in bulk when the
+ * queue is drained at the top of the timer tick.  With a single producer
+ * (the packet interrupt) and a single consumer (the tick) no locking is
+ * required: the producer only writes the tail, the consumer only writes
+ * the head.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+#include "nengo-common.h"
+
+#ifndef __PACKET_QUEUE_H__
+#define __PACKET_QUEUE_H__
+
+/*! \brief A single buffered MC packet.
+ */
+typedef struct packet {
+  uint key;      //!< MC packet key
+  uint payload;  //!< MC packet payload
+} packet_t;
+
+/*! \brief Lock-free single-producer single-consumer packet ring.
+ */
+typedef struct packet_queue {
+  packet_t *packets;   //!< Ring storage
+  uint size;           //!< Capacity of the ring + 1 (one slot kept free)
+  volatile uint head;  //!< Next slot to read (written by consumer only)
+  volatile uint tail;  //!< Next slot to write (written by producer only)
+  uint dropped;        //!< Count of packets dropped due to a full ring
+} packet_queue_t;
+
+//! Create a packet queue with storage for `size` packets
+static inline bool packet_queue_initialise(packet_queue_t *queue, uint size) {
+  MALLOC_FAIL_FALSE(queue->packets, (size + 1) * sizeof(packet_t));
+  queue->size = size + 1;
+  queue->head = 0;
+  queue->tail = 0;
+  queue->dropped = 0;
+  return true;
+}
+
+//! Push a packet onto the queue, returns false if the queue was full
+static inline bool packet_queue_push(packet_queue_t *queue, uint key,
+                                     uint payload) {
+  uint tail = queue->tail;
+  uint next = tail + 1;
+  if (next == queue->size) {
+    next = 0;
+  }
+
+  if (next == queue->head) {
+    // Queue full: the packet is dropped
+    queue->dropped++;
+    return false;
+  }
+
+  queue->packets[tail].key = key;
+  queue->packets[tail].payload = payload;
+  queue->tail = next;
+  return true;
+}
+
+//! Pop a packet from the queue, returns false if the queue was empty
+static inline bool packet_queue_pop(packet_queue_t *queue, uint *key,
+                                    uint *payload) {
+  uint head = queue->head;
+  if (head == queue->tail) {
+    return false;
+  }
+
+  *key = queue->packets[head].key;
+  *payload = queue->packets[head].payload;
+
+  head++;
+  if (head == queue->size) {
+    head = 0;
+  }
+  queue->head = head;
+  return true;
+}
+
+#endif
+
+/*! @} */
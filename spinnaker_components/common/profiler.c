@@ -0,0 +1,52 @@
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+profiler_phase_data_t profiler_phases[PROFILER_N_PHASES];
+uint profiler_phase_start[PROFILER_N_PHASES];
+
+
+void profiler_init(void) {
+  // Start Timer 2 as a free-running 32-bit down counter, no interrupt
+  tc[T2_LOAD] = 0xFFFFFFFF;
+  tc[T2_CONTROL] = 0x82;
+
+  for (uint p = 0; p < PROFILER_N_PHASES; p++) {
+    profiler_phases[p].min = 0;
+    profiler_phases[p].max = 0;
+    profiler_phases[p].mean = 0;
+    profiler_phases[p].count = 0;
+    profiler_phases[p].sum = 0;
+  }
+}
+
+
+void profiler_finalise(void) {
+  // Compute the means now that sampling has finished
+  for (uint p = 0; p < PROFILER_N_PHASES; p++) {
+    if (profiler_phases[p].count > 0) {
+      profiler_phases[p].mean =
+        (uint) (profiler_phases[p].sum / profiler_phases[p].count);
+    }
+
+    io_printf(IO_BUF, "[Profiler] Phase %d: min %u, max %u, mean %u cycles"
+              " over %u samples\n", p, profiler_phases[p].min,
+              profiler_phases[p].max, profiler_phases[p].mean,
+              profiler_phases[p].count);
+  }
+
+  // Copy the statistics to SDRAM and publish the address for the host
+  profiler_phase_data_t *sdram = sark_xalloc(
+    sv->sdram_heap, PROFILER_N_PHASES * sizeof(profiler_phase_data_t),
+    0, ALLOC_LOCK);
+  if (sdram == NULL) {
+    io_printf(IO_BUF, "[Profiler] Failed to claim SDRAM for results.\n");
+    return;
+  }
+
+  spin1_memcpy(sdram, profiler_phases,
+               PROFILER_N_PHASES * sizeof(profiler_phase_data_t));
+  sark.vcpu->user1 = (uint) sdram;
+}
+
+#endif  /* PROFILER_ENABLED */
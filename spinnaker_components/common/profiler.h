@@ -0,0 +1,94 @@
+/*!\addtogroup PROFILER
+ * \brief Per-phase cycle counting for the timer tick of any component.
+ *
+ * The spare hardware timer (Timer 2) is run as a free-running 32-bit
+ * counter and read at the start and end of named phases of the tick.
+ * Minimum, maximum and mean cycle counts are accumulated per phase and
+ * written to a block of SDRAM when the simulation finishes; the address
+ * of the block is published in the core's vcpu->user1 word so the host
+ * can read the results back after spin1_exit.
+ *
+ * Profiling is compiled in by building with -DPROFILER_ENABLED (see the
+ * commented CFLAGS line in each component Makefile); without it every
+ * call compiles to nothing.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+/*! \brief Named phases of a component's timer tick.
+ */
+typedef enum profiler_phase {
+  PROFILER_PHASE_INPUT = 0,  //!< Packet drain and input_filter_step
+  PROFILER_PHASE_UPDATE,     //!< Neuron update or transform multiply
+  PROFILER_PHASE_DECODE,     //!< Spike decode pass
+  PROFILER_PHASE_TRANSMIT,   //!< Output packet / SDP transmission
+  PROFILER_PHASE_RECORD,     //!< Recording buffer flush
+  PROFILER_N_PHASES
+} profiler_phase_t;
+
+/*! \brief Accumulated statistics for one phase.
+ *  This is also the layout of the per-phase results in SDRAM.
+ */
+typedef struct profiler_phase_data {
+  uint min;                //!< Shortest sample / cycles
+  uint max;                //!< Longest sample / cycles
+  uint mean;               //!< Mean sample / cycles (computed at finalise)
+  uint count;              //!< Number of samples
+  unsigned long long sum;  //!< Total cycles across all samples
+} profiler_phase_data_t;
+
+#ifdef PROFILER_ENABLED
+
+extern profiler_phase_data_t profiler_phases[PROFILER_N_PHASES];
+extern uint profiler_phase_start[PROFILER_N_PHASES];
+
+/*! \brief Start Timer 2 free-running and zero the phase statistics.
+ */
+void profiler_init(void);
+
+/*! \brief Compute means, copy the statistics to SDRAM and publish the
+ *         address in vcpu->user1.  Call before spin1_exit.
+ */
+void profiler_finalise(void);
+
+//! Note the entry to a phase
+static inline void profiler_start(profiler_phase_t phase) {
+  profiler_phase_start[phase] = tc[T2_COUNT];
+}
+
+//! Note the exit from a phase and accumulate the sample
+static inline void profiler_end(profiler_phase_t phase) {
+  // Timer 2 counts down
+  uint cycles = profiler_phase_start[phase] - tc[T2_COUNT];
+  profiler_phase_data_t *data = &profiler_phases[phase];
+
+  if (data->count == 0 || cycles < data->min) {
+    data->min = cycles;
+  }
+  if (cycles > data->max) {
+    data->max = cycles;
+  }
+  data->sum += cycles;
+  data->count++;
+}
+
+#else  /* !PROFILER_ENABLED */
+
+static inline void profiler_init(void) {}
+static inline void profiler_finalise(void) {}
+static inline void profiler_start(profiler_phase_t phase) { use(phase); }
+static inline void profiler_end(profiler_phase_t phase) { use(phase); }
+
+#endif
+
+#endif
+
+/*! @} */
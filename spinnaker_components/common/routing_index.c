@@ -0,0 +1,128 @@
+#include "routing_index.h"
+#include "input_filter.h"
+#include "dual_value.h"
+
+
+cold_fn bool routing_index_build(routing_index_t *index, input_filter_t **inputs,
+                         uint n_inputs)
+{
+  // Count the routes to index
+  uint n_routes = 0;
+  for (uint i = 0; i < n_inputs; i++) {
+    n_routes += inputs[i]->n_routes;
+  }
+
+  // Determine the set of distinct masks
+  index->n_buckets = 0;
+  if (n_routes == 0) {
+    index->buckets = NULL;
+    return true;
+  }
+
+  MALLOC_FAIL_FALSE(index->buckets,
+                    n_routes * sizeof(routing_index_bucket_t));
+
+  for (uint i = 0; i < n_inputs; i++) {
+    for (uint r = 0; r < inputs[i]->n_routes; r++) {
+      uint mask = inputs[i]->routes[r].mask;
+
+      bool seen = false;
+      for (uint b = 0; b < index->n_buckets; b++) {
+        if (index->buckets[b].mask == mask) {
+          index->buckets[b].n_entries++;
+          seen = true;
+          break;
+        }
+      }
+
+      if (!seen) {
+        index->buckets[index->n_buckets].mask = mask;
+        index->buckets[index->n_buckets].n_entries = 1;
+        index->n_buckets++;
+      }
+    }
+  }
+
+  // Allocate the entries for each bucket
+  for (uint b = 0; b < index->n_buckets; b++) {
+    MALLOC_FAIL_FALSE(index->buckets[b].entries,
+                      index->buckets[b].n_entries *
+                        sizeof(routing_index_entry_t));
+    index->buckets[b].n_entries = 0;  // Refilled during insertion below
+  }
+
+  /* Insert each route into its bucket, keeping the entries sorted by key.
+   * Insertion sort is fine here: this runs once at load time and buckets
+   * are small.
+   */
+  for (uint i = 0; i < n_inputs; i++) {
+    for (uint r = 0; r < inputs[i]->n_routes; r++) {
+      input_filter_key_t *route = &inputs[i]->routes[r];
+
+      routing_index_bucket_t *bucket = NULL;
+      for (uint b = 0; b < index->n_buckets; b++) {
+        if (index->buckets[b].mask == route->mask) {
+          bucket = &index->buckets[b];
+          break;
+        }
+      }
+
+      uint p = bucket->n_entries;
+      while (p > 0 && bucket->entries[p - 1].key > route->key) {
+        bucket->entries[p] = bucket->entries[p - 1];
+        p--;
+      }
+      bucket->entries[p].key = route->key;
+      bucket->entries[p].dimension_mask = route->dimension_mask;
+      bucket->entries[p].input = inputs[i];
+      // The top bit of the filter word flags packed dual-value payloads
+      bucket->entries[p].filter = route->filter & ~DUAL_VALUE_ROUTE_FLAG;
+      bucket->entries[p].packed = route->filter & DUAL_VALUE_ROUTE_FLAG;
+      bucket->n_entries++;
+    }
+  }
+
+  io_printf(IO_BUF, "[Routing Index] %d routes in %d mask buckets.\n",
+            n_routes, index->n_buckets);
+  for (uint b = 0; b < index->n_buckets; b++) {
+    io_printf(IO_BUF, "[Routing Index] Bucket %d: mask 0x%08x, %d entries\n",
+              b, index->buckets[b].mask, index->buckets[b].n_entries);
+  }
+
+  return true;
+}
+
+
+hot_fn bool routing_index_mcpl_rx(routing_index_t *index, uint key, uint payload) {
+  for (uint b = 0; b < index->n_buckets; b++) {
+    routing_index_bucket_t *bucket = &index->buckets[b];
+    uint masked_key = key & bucket->mask;
+
+    // Binary search for the masked key within the bucket
+    uint lo = 0, hi = bucket->n_entries;
+    while (lo < hi) {
+      uint mid = (lo + hi) >> 1;
+      routing_index_entry_t *entry = &bucket->entries[mid];
+
+      if (entry->key == masked_key) {
+        uint d = key & entry->dimension_mask;
+        if (entry->packed) {
+          // Payload carries dimensions (d, d + 1) as two s7.8 halves
+          input_buffer_acc(entry->input->filters[entry->filter], d,
+                           dual_value_unpack_low(payload));
+          input_buffer_acc(entry->input->filters[entry->filter], d + 1,
+                           dual_value_unpack_high(payload));
+        } else {
+          input_buffer_acc(entry->input->filters[entry->filter], d,
+                           kbits(payload));
+        }
+        return true;
+      } else if (entry->key < masked_key) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,67 @@
+/*!\addtogroup ROUTING_INDEX
+ * \brief An indexed lookup structure mapping MC packet keys to input filters.
+ *
+ * Routes are grouped into buckets by mask (models use only a handful of
+ * distinct masks) and sorted by key within each bucket, so an incoming
+ * packet resolves to its filter and dimension with a binary search per
+ * bucket rather than a linear scan of every route.  An index may be built
+ * over several input filter collections so that a vertex with multiple
+ * inputs (e.g. the Ensemble's excitatory, inhibitory and modulatory
+ * filters) performs a single lookup per packet.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+#include "common-typedefs.h"
+
+#ifndef __ROUTING_INDEX_H__
+#define __ROUTING_INDEX_H__
+
+// Forward declaration, see input_filter.h
+struct _input_filter_t;
+
+/*! \brief A single indexed route.
+ */
+typedef struct routing_index_entry {
+  uint key;              //!< Route key (pre-masked)
+  uint dimension_mask;   //!< Mask to retrieve dimension from key
+  struct _input_filter_t *input; //!< Input filter collection for this route
+  uint filter;           //!< Filter ID within the collection
+  uint packed;           //!< True if payloads carry two packed dimensions
+} routing_index_entry_t;
+
+/*! \brief Routes sharing one mask, sorted by key.
+ */
+typedef struct routing_index_bucket {
+  uint mask;                      //!< Common route mask
+  uint n_entries;                 //!< Number of routes with this mask
+  routing_index_entry_t *entries; //!< Routes sorted by key
+} routing_index_bucket_t;
+
+/*! \brief Key lookup index over one or more input filter collections.
+ */
+typedef struct routing_index {
+  uint n_buckets;                  //!< Number of distinct masks
+  routing_index_bucket_t *buckets; //!< Per-mask buckets
+} routing_index_t;
+
+/*! \brief Build an index over the routes of the given collections.
+ *  Must be called after the routes of every collection have been loaded.
+ *  \returns Success of the function.
+ */
+bool routing_index_build(routing_index_t *index,
+                         struct _input_filter_t **inputs, uint n_inputs);
+
+/*! \brief Resolve a packet and accumulate its payload into the correct
+ *         filter dimension.
+ *  \returns True if the key routed to a filter within the index.
+ */
+bool routing_index_mcpl_rx(routing_index_t *index, uint key, uint payload);
+
+#endif
+
+/*! @} */
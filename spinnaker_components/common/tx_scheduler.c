@@ -0,0 +1,98 @@
+#include "tx_scheduler.h"
+#include "packet_queue.h"
+
+static uint interpacket_us;        //!< Inter-packet interval / useconds
+
+#ifndef PROFILER_ENABLED
+
+static packet_queue_t queue;       //!< Outgoing packets awaiting transmission
+static uint interval;              //!< Timer 2 reload value between packets
+static volatile bool active;       //!< True while Timer 2 is running
+
+/* Timer 2 interrupt: transmit one packet and stop the timer once the
+ * queue has drained.
+ */
+static INT_HANDLER tx_scheduler_isr(void) {
+  tc[T2_INT_CLR] = 1;
+
+  uint key, payload;
+  if (packet_queue_pop(&queue, &key, &payload)) {
+    spin1_send_mc_packet(key, payload, WITH_PAYLOAD);
+  }
+
+  if (queue.head == queue.tail) {
+    // Queue empty: stop Timer 2 until the next tx_scheduler_send
+    tc[T2_CONTROL] = 0;
+    active = false;
+  }
+
+  vic[VIC_VADDR] = (uint) vic;
+}
+
+
+bool tx_scheduler_initialise(uint n_packets, uint pause_us) {
+  if (!packet_queue_initialise(&queue, n_packets)) {
+    return false;
+  }
+
+  interpacket_us = pause_us;
+  interval = pause_us * sv->cpu_clk;  // Timer 2 runs at the CPU clock
+  active = false;
+
+  if (sark_vic_set(SLOT_13, TIMER2_INT, 1, tx_scheduler_isr) != SLOT_13) {
+    io_printf(IO_BUF, "[Tx Scheduler] Failed to claim VIC slot.\n");
+    return false;
+  }
+
+  io_printf(IO_BUF, "[Tx Scheduler] Inter-packet interval %d us.\n",
+            pause_us);
+  return true;
+}
+
+
+void tx_scheduler_send(uint key, uint payload) {
+  if (!packet_queue_push(&queue, key, payload)) {
+    // Queue full: send immediately rather than dropping the packet
+    spin1_send_mc_packet(key, payload, WITH_PAYLOAD);
+    return;
+  }
+
+  if (!active) {
+    // Start Timer 2: periodic, 32-bit, interrupting every interval
+    active = true;
+    tc[T2_LOAD] = interval;
+    tc[T2_CONTROL] = 0xe2;
+  }
+}
+
+
+void tx_scheduler_flush(void) {
+  while (active) {
+    continue;
+  }
+}
+
+#else  /* PROFILER_ENABLED */
+
+/* The profiler owns Timer 2, so fall back to immediate transmission paced
+ * with the busy-wait the scheduler normally replaces.
+ */
+bool tx_scheduler_initialise(uint n_packets, uint pause_us) {
+  use(n_packets);
+  interpacket_us = pause_us;
+  io_printf(IO_BUF, "[Tx Scheduler] Profiler owns Timer 2; transmitting"
+            " with busy-wait pacing.\n");
+  return true;
+}
+
+
+void tx_scheduler_send(uint key, uint payload) {
+  spin1_send_mc_packet(key, payload, WITH_PAYLOAD);
+  spin1_delay_us(interpacket_us);
+}
+
+
+void tx_scheduler_flush(void) {
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*!\addtogroup TX_SCHEDULER
+ * \brief Paced transmission of MC packets from a Timer 2 interrupt.
+ *
+ * Components previously spread their outgoing packets with
+ * spin1_delay_us busy-waits, burning CPU the update loops need.  The
+ * scheduler instead queues (key, payload) pairs and drips them onto the
+ * router from a Timer 2 interrupt at a configurable inter-packet
+ * interval: Timer 2 runs periodically only while the queue is non-empty,
+ * so transmission is spread across the tick and costs the update loop a
+ * couple of stores per packet.
+ *
+ * One scheduler exists per core.  When the profiler is compiled in it
+ * owns Timer 2 instead, and the scheduler falls back to immediate sends
+ * paced with spin1_delay_us.
+ *
+ * \author Andrew Mundy <mundya@cs.man.ac.uk>
+ * \copyright Advanced Processor Technologies, School of Computer Science,
+ *            University of Manchester
+ * @{
+ */
+
+#include "spin1_api.h"
+#include "nengo-common.h"
+
+#ifndef __TX_SCHEDULER_H__
+#define __TX_SCHEDULER_H__
+
+/*! \brief Initialise the core's transmit scheduler.
+ *  \param n_packets Capacity of the outgoing packet queue
+ *  \param interpacket_us Interval between packet transmissions / useconds
+ *  \returns Success of the function.
+ */
+bool tx_scheduler_initialise(uint n_packets, uint interpacket_us);
+
+/*! \brief Queue a packet for paced transmission.
+ *
+ * If the queue is full the packet is transmitted immediately instead, so
+ * packets are never lost to scheduling.
+ */
+void tx_scheduler_send(uint key, uint payload);
+
+/*! \brief Block until every queued packet has been transmitted.
+ *
+ * Only needed when packets must be flushed before the core stops, e.g.
+ * immediately before spin1_exit.
+ */
+void tx_scheduler_flush(void);
+
+#endif
+
+/*! @} */
@@ -36,6 +36,24 @@
 #include "dimensional-io.h"
 #include "recording.h"
 #include "input_filter.h"
+#include "packet_queue.h"
+#include "profiler.h"
+#include "dual_value.h"
+#include "tx_scheduler.h"
+
+/* Constants ****************************************************************/
+/** \brief Combined encoder + decoder size (bytes) above which the matrices
+ *         are streamed from SDRAM rather than held in DTCM.
+ *
+ * The limit is deliberately conservative: the filters, output buffers and
+ * recording buffer are allocated after the matrices and must still fit.
+ */
+#define MATRIX_DTCM_LIMIT (32 * 1024)
+
+/** \brief Target size (bytes) of one streamed block of encoder or decoder
+ *         rows.  Two blocks of each matrix are resident at any time.
+ */
+#define MATRIX_BLOCK_BYTES (4 * 1024)
 
 /* Structs ******************************************************************/
 /** \brief Representation of system region. See ::data_system. */
@@ -47,28 +65,76 @@ typedef struct region_system
   uint machine_timestep;
   uint t_ref;
   value_t dt_over_t_rc;
-  bool record_spikes;
+  uint record_spikes;  //!< Spike recording format, see RECORD_FORMAT_*
   uint n_inhibitory_dimensions;
+  uint flags;  //!< See ENSEMBLE_FLAG_*
+  uint shared_input_tag;  //!< SysRAM tag of the shared input block (or 0)
+  uint record_voltage;  //!< Membrane voltage recording, see RECORD_DECIMATE_*
 } region_system_t;
 
+/** \brief Transmit decoded output as packed dual-value payloads.  See
+ *         dual_value.h for the wire format.
+ */
+#define ENSEMBLE_FLAG_PACKED_OUTPUT 0x00000001
+
+/** \brief This core filters the input for a multi-core ensemble and
+ *         publishes the filtered vector to SysRAM each tick.
+ */
+#define ENSEMBLE_FLAG_SHARED_INPUT_HEAD 0x00000002
+
+/** \brief This core reads its input from the SysRAM block published by a
+ *         sibling head core instead of filtering packets itself.  Follower
+ *         cores receive no input routes and may not carry learning rules.
+ */
+#define ENSEMBLE_FLAG_SHARED_INPUT_FOLLOW 0x00000004
+
+/** \brief Filtered input vector shared between the cores of a multi-core
+ *         ensemble, resident in SysRAM.
+ *
+ * The head core performs the input filtering once per tick and publishes
+ * the result here; follower cores run the neuron and decode loops over
+ * their own neuron slice against this buffer.  values holds the
+ * \f$D_{in}\f$ filtered input dimensions followed by the summed
+ * inhibitory input.  sequence carries the tick number of the most recent
+ * publication and is written last.
+ */
+typedef struct shared_input {
+  volatile uint sequence;  //!< Tick number of the last published vector
+  uint n_dimensions;       //!< Number of input dimensions published
+  value_t values[];        //!< D_in inputs, then the summed inhibition
+} shared_input_t;
+
 /** \brief Persistent neuron variables.
-  */
+ *
+ * By default the voltage and refractory state of each neuron are packed
+ * into one word; building with -DENSEMBLE_STATE_SOA instead keeps separate
+ * voltage and refractory arrays, trading N bytes of DTCM for the removal
+ * of the bitfield extract/insert sequences from the neuron update loop.
+ */
+#ifndef ENSEMBLE_STATE_SOA
 typedef struct neuron_status {
   unsigned char refractory_time : 4;  //!< 4 bits of refractory state
   unsigned int  voltage : 28;           //!< 28 bits stored voltage
 } neuron_status_t;
+#endif
 
 /** \brief Shared ensemble parameters.
   */
 typedef struct ensemble_parameters {
   uint n_neurons;          //!< Number of neurons \f$N\f$
   uint machine_timestep;   //!< Machine time step  / useconds
+  uint flags;              //!< Behaviour flags, see ENSEMBLE_FLAG_*
 
   uint t_ref;              //!< Refractory period \f$\tau_{ref} - 1\f$ / steps
   value_t dt_over_t_rc;    //!< \f$\frac{dt}{\tau_{rc}}\$
 
   current_t *i_bias;        //!< Population biases \f$1 \times N\f$
+#ifdef ENSEMBLE_STATE_SOA
+  voltage_t *voltages;      //!< Membrane voltages \f$1 \times N\f$
+  uchar *refractory;        //!< Refractory counters \f$1 \times N\f$
+#else
   neuron_status_t *status;  //!< Neuron status
+#endif
 
   uint n_inhib_dims;        //!< Number of dimensions in inhibitory connection
   value_t *inhib_gain;      //!< Gain of inhibitory connection (value of transform)
@@ -76,10 +142,30 @@ typedef struct ensemble_parameters {
   value_t *encoders;        //!< Encoder values \f$N \times D_{in}\f$ (including gains)
   value_t *decoders;        //!< Decoder values \f$N \times\sum D_{outs}\f$
 
+  bool decoders_banded;     //!< True if decoders stored in banded form
+  uint *decoder_offset;     //!< Offset of each packed decoder row (banded)
+  uint *decoder_start;      //!< First nonzero column per neuron (banded)
+  uint *decoder_length;     //!< Nonzero span length per neuron (banded)
+
+  bool stream_matrices;     //!< True if encoders/decoders streamed from SDRAM
+  uint block_rows;          //!< Neurons per streamed block
+  value_t *encoders_sdram;  //!< Encoder matrix in SDRAM (streaming mode)
+  value_t *decoders_sdram;  //!< Decoder matrix in SDRAM (streaming mode)
+  value_t *encoder_blocks[2];  //!< Ping-pong DTCM encoder row blocks
+  value_t *decoder_blocks[2];  //!< Ping-pong DTCM decoder row blocks
+
   value_t *input;           //!< Input buffer
   value_t *output;          //!< Output buffer
 
+  uint *spike_list;         //!< Block-relative indices of spiking neurons
+  uint n_spikes;            //!< Number of spikes in the current block
+
+  shared_input_t *shared_input;  //!< Shared input block in SysRAM (or NULL)
+
   recording_buffer_t recd;  //!< Spike recording
+  recording_buffer_t recd_voltage;  //!< Membrane voltage recording
+  uint record_voltage;      //!< Voltage recording configuration
+  value_t *voltage_frame;   //!< Gather buffer for voltage recording
 } ensemble_parameters_t;
 
 /* Parameters and Buffers ***************************************************/
@@ -88,10 +174,18 @@ extern uint g_output_period;       //!< Delay in transmitting decoded output
 
 extern uint g_n_output_dimensions;
 
+extern volatile uint g_stream_dma_pending;  //!< Outstanding matrix block DMAs
+
 extern input_filter_t g_input;     //!< Input filters and buffers
 extern input_filter_t g_input_inhibitory;     //!< Input filters and buffers
 extern input_filter_t g_input_modulatory;     //!< Input filters and buffers
 
+//! Merged key lookup across all three input filter collections
+extern routing_index_t g_routing_index;
+
+//! Buffered packets awaiting routing at the next tick
+extern packet_queue_t g_packet_queue;
+
 /* Functions ****************************************************************/
 /**
  * \brief Initialise the ensemble.
@@ -127,6 +221,27 @@ static inline value_t *neuron_decoder_vector(uint n)
 }
 
 // -- Voltages and refractory periods
+#ifdef ENSEMBLE_STATE_SOA
+//! Get the membrane voltage for the given neuron
+static inline voltage_t neuron_voltage( uint n )
+  { return g_ensemble.voltages[n]; };
+
+//! Set the membrane voltage for the given neuron
+static inline void set_neuron_voltage( uint n, voltage_t v )
+  { g_ensemble.voltages[n] = v; };
+
+//! Get the refractory status of a given neuron
+static inline uint neuron_refractory( uint n )
+  { return g_ensemble.refractory[n]; };
+
+//! Put the given neuron in a refractory state (zero voltage, set timer)
+static inline void set_neuron_refractory( uint n )
+  { g_ensemble.refractory[n] = g_ensemble.t_ref; };
+
+//! Decrement the refractory time for the given neuron
+static inline void decrement_neuron_refractory( uint n )
+  { g_ensemble.refractory[n]--; };
+#else
 //! Get the membrane voltage for the given neuron
 static inline voltage_t neuron_voltage( uint n )
   { return kbits( g_ensemble.status[n].voltage ); };
@@ -146,6 +261,7 @@ static inline void set_neuron_refractory( uint n )
 //! Decrement the refractory time for the given neuron
 static inline void decrement_neuron_refractory( uint n )
   { g_ensemble.status[n].refractory_time--; };
+#endif
 
 #endif
 
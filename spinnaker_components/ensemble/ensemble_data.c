@@ -14,7 +14,9 @@
  */
 
 #include "ensemble_data.h"
+#include "init_dma.h"
 #include "ensemble_output.h"
+#include "ensemble_pes.h"
 
 bool data_system(address_t addr) {
   return initialise_ensemble((region_system_t *) addr);
@@ -24,8 +26,9 @@ bool data_get_bias(
   address_t addr,
   uint n_neurons
 ){
-  spin1_memcpy( g_ensemble.i_bias, addr,
-    n_neurons * sizeof( current_t ) );
+  // Load in the background; the next init_dma_copy or the barrier in
+  // c_main completes it
+  init_dma_copy( g_ensemble.i_bias, addr, n_neurons * sizeof( current_t ) );
   return true;
 }
 
@@ -34,7 +37,13 @@ bool data_get_encoders(
   uint n_neurons,
   uint n_input_dimensions
 ){
-  spin1_memcpy( g_ensemble.encoders, addr,
+  if( g_ensemble.stream_matrices ){
+    // Streaming: the matrix stays in SDRAM and is DMAd in row blocks
+    g_ensemble.encoders_sdram = (value_t *) addr;
+    return true;
+  }
+
+  init_dma_copy( g_ensemble.encoders, addr,
     n_neurons * n_input_dimensions * sizeof( value_t ) );
   return true;
 }
@@ -44,15 +53,92 @@ bool data_get_decoders(
   uint n_neurons,
   uint n_output_dimensions
 ){
-  spin1_memcpy( g_ensemble.decoders, addr,
-    n_neurons * n_output_dimensions * sizeof( value_t ) );
+  if( g_ensemble.stream_matrices ){
+    // Streaming: the matrix stays in SDRAM and is DMAd in row blocks
+    g_ensemble.decoders_sdram = (value_t *) addr;
+    return true;
+  }
+
+  /* Scan the dense matrix (still in SDRAM) for the nonzero span of each
+   * row.  If storing only the spans is a net saving - and no PES rule will
+   * write outside them - the decoders are packed into a banded form;
+   * otherwise the full dense matrix is copied into DTCM as before.
+   */
+  value_t *dense = (value_t *) addr;
+  uint dense_words = n_neurons * n_output_dimensions;
+  uint packed_words = 0;
+
+  for( uint n = 0; n < n_neurons; n++ ){
+    value_t *row = &dense[n * n_output_dimensions];
+    uint first = n_output_dimensions, last = 0;
+    for( uint d = 0; d < n_output_dimensions; d++ ){
+      if( row[d] != 0.0k ){
+        if( first == n_output_dimensions ) first = d;
+        last = d;
+      }
+    }
+    if( first != n_output_dimensions ){
+      packed_words += last - first + 1;
+    }
+  }
 
+  // Three index words per neuron are needed on top of the packed values
+  g_ensemble.decoders_banded =
+    ( g_num_pes_learning_rules == 0 &&
+      packed_words + 3 * n_neurons < dense_words );
+
+  if( !g_ensemble.decoders_banded ){
+    MALLOC_FAIL_FALSE( g_ensemble.decoders,
+                       dense_words * sizeof( value_t ) );
+    init_dma_copy( g_ensemble.decoders, addr,
+      n_neurons * n_output_dimensions * sizeof( value_t ) );
+
+    // Dump the decoders from their SDRAM copy, which the in-flight DMA
+    // does not touch
+    for( uint n = 0; n < n_neurons; n++ ){
+      io_printf( IO_BUF, "Decoder[%d] = ", n );
+      for( uint d = 0; d < n_output_dimensions; d++ ){
+        io_printf( IO_BUF, "%k, ",
+                   kbits( addr[n * n_output_dimensions + d] ) );
+      }
+      io_printf( IO_BUF, "\n" );
+    }
+
+    return true;
+  }
+
+  io_printf( IO_BUF, "[Ensemble] Banded decoders: %d of %d words\n",
+             packed_words, dense_words );
+
+  MALLOC_FAIL_FALSE( g_ensemble.decoders,
+                     packed_words * sizeof( value_t ) );
+  MALLOC_FAIL_FALSE( g_ensemble.decoder_offset, n_neurons * sizeof( uint ) );
+  MALLOC_FAIL_FALSE( g_ensemble.decoder_start, n_neurons * sizeof( uint ) );
+  MALLOC_FAIL_FALSE( g_ensemble.decoder_length, n_neurons * sizeof( uint ) );
+
+  uint offset = 0;
   for( uint n = 0; n < n_neurons; n++ ){
-    io_printf( IO_BUF, "Decoder[%d] = ", n );
+    value_t *row = &dense[n * n_output_dimensions];
+    uint first = n_output_dimensions, last = 0;
     for( uint d = 0; d < n_output_dimensions; d++ ){
-      io_printf( IO_BUF, "%k, ", neuron_decoder( n, d ) );
+      if( row[d] != 0.0k ){
+        if( first == n_output_dimensions ) first = d;
+        last = d;
+      }
+    }
+
+    g_ensemble.decoder_offset[n] = offset;
+    if( first == n_output_dimensions ){
+      // Row is entirely zero
+      g_ensemble.decoder_start[n] = 0;
+      g_ensemble.decoder_length[n] = 0;
+    } else {
+      g_ensemble.decoder_start[n] = first;
+      g_ensemble.decoder_length[n] = last - first + 1;
+      spin1_memcpy( &g_ensemble.decoders[offset], &row[first],
+                    ( last - first + 1 ) * sizeof( value_t ) );
+      offset += last - first + 1;
     }
-    io_printf( IO_BUF, "\n" );
   }
 
   return true;
@@ -21,18 +21,33 @@ ensemble_parameters_t g_ensemble;
 input_filter_t g_input;
 input_filter_t g_input_inhibitory;
 input_filter_t g_input_modulatory;
+routing_index_t g_routing_index;
+packet_queue_t g_packet_queue;
 
-/* Multicast Wrapper ********************************************************/
-void mcpl_rx(uint key, uint payload) 
+volatile uint g_stream_dma_pending = 0;
+
+/* DMA Wrapper **************************************************************/
+void dma_complete(uint arg0, uint tag)
 {
-  bool handled = false;
-  handled |= input_filter_mcpl_rx(&g_input, key, payload);
-  handled |= input_filter_mcpl_rx(&g_input_inhibitory, key, payload);
-  handled |= input_filter_mcpl_rx(&g_input_modulatory, key, payload);
+  use(arg0);
+  if (tag == 0 && g_stream_dma_pending > 0) {
+    g_stream_dma_pending--;
+  }
+}
 
-  if(!handled)
+/* Multicast Wrapper ********************************************************/
+void mcpl_rx(uint key, uint payload)
+{
+  /* Defer all routing work out of interrupt context: just buffer the raw
+   * packet, it will be routed and accumulated at the top of the next tick.
+   */
+  if(!packet_queue_push(&g_packet_queue, key, payload))
   {
-      io_printf(IO_BUF, "[MCPL Rx] Unknown key %08x\n", key);
+    // Queue full: report the first drop only, to avoid printing in a storm
+    if(g_packet_queue.dropped == 1)
+    {
+      io_printf(IO_BUF, "[MCPL Rx] Packet queue full, dropping packets.\n");
+    }
   }
 }
 
@@ -43,7 +58,52 @@ bool initialise_ensemble(region_system_t *pars) {
   g_ensemble.machine_timestep = pars->machine_timestep;
   g_ensemble.t_ref = pars->t_ref;
   g_ensemble.dt_over_t_rc = pars->dt_over_t_rc;
-  g_ensemble.recd.record = pars->record_spikes;
+  g_ensemble.flags = pars->flags;
+  g_ensemble.recd.format = pars->record_spikes;
+  g_ensemble.recd.record = (pars->record_spikes != RECORD_FORMAT_NONE);
+  g_ensemble.record_voltage = pars->record_voltage;
+
+  /* Shared input for multi-core ensembles: the head core allocates a
+   * tagged block in SysRAM and publishes its filtered input vector there
+   * each tick; follower cores locate the block by tag and read from it
+   * instead of filtering packets themselves.
+   */
+  g_ensemble.shared_input = NULL;
+  if (pars->flags & ENSEMBLE_FLAG_SHARED_INPUT_HEAD) {
+    uint shared_bytes = sizeof(shared_input_t) +
+                        (pars->n_input_dimensions + 1) * sizeof(value_t);
+    g_ensemble.shared_input = sark_xalloc(
+        sv->sysram_heap, shared_bytes, pars->shared_input_tag,
+        ALLOC_LOCK | ALLOC_ID);
+    if (g_ensemble.shared_input == NULL) {
+      io_printf(IO_BUF, "[Ensemble] Failed to malloc shared input block"
+                " (tag %d) in SysRAM.\n", pars->shared_input_tag);
+      return false;
+    }
+
+    g_ensemble.shared_input->sequence = 0;
+    g_ensemble.shared_input->n_dimensions = pars->n_input_dimensions;
+    io_printf(IO_BUF, "[Ensemble] Publishing shared input with tag %d.\n",
+              pars->shared_input_tag);
+  } else if (pars->flags & ENSEMBLE_FLAG_SHARED_INPUT_FOLLOW) {
+    /* The head core may not have allocated the block yet: all cores load
+     * before the sync barrier, in no particular order.
+     */
+    for (uint attempt = 0; attempt < 10000; attempt++) {
+      g_ensemble.shared_input = sark_tag_ptr(pars->shared_input_tag, 0);
+      if (g_ensemble.shared_input != NULL) {
+        break;
+      }
+      spin1_delay_us(1000);
+    }
+    if (g_ensemble.shared_input == NULL) {
+      io_printf(IO_BUF, "[Ensemble] No shared input block with tag %d.\n",
+                pars->shared_input_tag);
+      return false;
+    }
+    io_printf(IO_BUF, "[Ensemble] Reading shared input with tag %d.\n",
+              pars->shared_input_tag);
+  }
 
   io_printf(IO_BUF, "[Ensemble] INITIALISE_ENSEMBLE n_neurons = %d," \
             "timestep = %d, t_ref = %d, dt_over_t_rc = 0x%08x\n",
@@ -58,6 +118,17 @@ bool initialise_ensemble(region_system_t *pars) {
                     g_ensemble.n_neurons * sizeof(current_t));
 
   // Holder for refractory period and voltages
+#ifdef ENSEMBLE_STATE_SOA
+  MALLOC_FAIL_FALSE(g_ensemble.voltages,
+                    g_ensemble.n_neurons * sizeof(voltage_t));
+  MALLOC_FAIL_FALSE(g_ensemble.refractory,
+                    g_ensemble.n_neurons * sizeof(uchar));
+
+  for (uint n = 0; n < g_ensemble.n_neurons; n++) {
+    g_ensemble.voltages[n] = 0.0k;
+    g_ensemble.refractory[n] = 0;
+  }
+#else
   MALLOC_FAIL_FALSE(g_ensemble.status,
                     g_ensemble.n_neurons * sizeof(neuron_status_t));
 
@@ -65,15 +136,49 @@ bool initialise_ensemble(region_system_t *pars) {
     g_ensemble.status[n].refractory_time = 0;
     g_ensemble.status[n].voltage = 0;
   }
+#endif
+
+  /* Initialise the encoder and decoder matrices.  Small matrices are held
+   * in DTCM as before; matrices which would not leave room for the filters
+   * and output buffers are left in SDRAM and streamed into ping-pong row
+   * blocks by ensemble_update (cf. the slot swapping in value_source).
+   */
+  uint encoder_bytes = g_ensemble.n_neurons * pars->n_input_dimensions *
+                         sizeof(value_t);
+  uint decoder_bytes = g_ensemble.n_neurons * pars->n_output_dimensions *
+                         sizeof(value_t);
+  g_ensemble.stream_matrices = (encoder_bytes + decoder_bytes >
+                                MATRIX_DTCM_LIMIT);
 
-  // Initialise some buffers
-  MALLOC_FAIL_FALSE(g_ensemble.encoders,
-                    g_ensemble.n_neurons * pars->n_input_dimensions *
-                      sizeof(value_t));
+  if (!g_ensemble.stream_matrices) {
+    MALLOC_FAIL_FALSE(g_ensemble.encoders, encoder_bytes);
+    /* The decoder buffer is allocated by data_get_decoders, which may pack
+     * mostly-zero decoders into a banded form requiring less space.
+     */
+  } else {
+    // Select a block length (in rows) such that the widest row block fits
+    // within the block budget, then allocate two blocks of each matrix.
+    uint row_bytes = (pars->n_input_dimensions > pars->n_output_dimensions ?
+                      pars->n_input_dimensions : pars->n_output_dimensions) *
+                     sizeof(value_t);
+    g_ensemble.block_rows = MATRIX_BLOCK_BYTES / row_bytes;
+    if (g_ensemble.block_rows == 0) {
+      g_ensemble.block_rows = 1;
+    }
 
-  MALLOC_FAIL_FALSE(g_ensemble.decoders,
-                    g_ensemble.n_neurons * pars->n_output_dimensions *
-                      sizeof(value_t));
+    io_printf(IO_BUF, "[Ensemble] Streaming %d + %d byte matrices from SDRAM"
+              " in blocks of %d rows.\n", encoder_bytes, decoder_bytes,
+              g_ensemble.block_rows);
+
+    for (uint i = 0; i < 2; i++) {
+      MALLOC_FAIL_FALSE(g_ensemble.encoder_blocks[i],
+                        g_ensemble.block_rows * pars->n_input_dimensions *
+                          sizeof(value_t));
+      MALLOC_FAIL_FALSE(g_ensemble.decoder_blocks[i],
+                        g_ensemble.block_rows * pars->n_output_dimensions *
+                          sizeof(value_t));
+    }
+  }
 
   // Setup subcomponents
   g_ensemble.input = input_filter_initialise(&g_input, pars->n_input_dimensions);
@@ -94,8 +199,19 @@ bool initialise_ensemble(region_system_t *pars) {
   if (g_ensemble.output == NULL && g_n_output_dimensions > 0)
     return false;
 
+  // Spike list for the batched decode pass, sized for the largest block
+  uint max_block = g_ensemble.stream_matrices ? g_ensemble.block_rows :
+                   g_ensemble.n_neurons;
+  MALLOC_FAIL_FALSE(g_ensemble.spike_list, max_block * sizeof(uint));
+  g_ensemble.n_spikes = 0;
+
+  // Create the deferred packet queue
+  if (!packet_queue_initialise(&g_packet_queue, 512))
+    return false;
+
   // Register the update function
   spin1_callback_on(TIMER_TICK, ensemble_update, 2);
   spin1_callback_on(MCPL_PACKET_RECEIVED, mcpl_rx, -1);
+  spin1_callback_on(DMA_TRANSFER_DONE, dma_complete, 0);
   return true;
 }
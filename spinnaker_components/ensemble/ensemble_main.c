@@ -1,6 +1,7 @@
 #include "ensemble.h"
 #include "ensemble_data.h"
 #include "ensemble_pes.h"
+#include "init_dma.h"
 
 void c_main(void) {
   // Set the system up
@@ -11,22 +12,38 @@ void c_main(void) {
     return;
   }
 
+  /* Load the PES configuration before the decoders: decoders may only be
+   * stored in banded form when no learning rule will write outside the
+   * nonzero span of each row.
+   */
+  if(!get_pes(region_start(13, address)))
+  {
+    io_printf(IO_BUF, "[Ensemble] Failed to start.\n");
+    return;
+  }
+
   // Get data
   data_get_bias(region_start(2, address), g_ensemble.n_neurons);
   data_get_encoders(region_start(3, address), g_ensemble.n_neurons, g_input.n_dimensions);
-  data_get_decoders(region_start(4, address), g_ensemble.n_neurons, g_n_output_dimensions);
+  if (!data_get_decoders(region_start(4, address), g_ensemble.n_neurons,
+                         g_n_output_dimensions)) {
+    io_printf(IO_BUF, "[Ensemble] Failed to start.\n");
+    return;
+  }
   data_get_keys(region_start(5, address), g_n_output_dimensions);
 
   // Get the inhibitory gains
-  g_ensemble.inhib_gain = spin1_malloc(g_ensemble.n_neurons * sizeof(value_t));
+  g_ensemble.inhib_gain = nengo_malloc(g_ensemble.n_neurons * sizeof(value_t));
   if (g_ensemble.inhib_gain == NULL) {
     io_printf(IO_BUF, "[Ensemble] Failed to malloc inhib gains.\n");
     return;
   }
-  spin1_memcpy(g_ensemble.inhib_gain, region_start(10, address),
-               g_ensemble.n_neurons * sizeof(value_t));
+  init_dma_copy(g_ensemble.inhib_gain, region_start(10, address),
+                g_ensemble.n_neurons * sizeof(value_t));
   for (uint n = 0; n < g_ensemble.n_neurons; n++) {
-    io_printf(IO_BUF, "Inhib gain[%d] = %k\n", n, g_ensemble.inhib_gain[n]);
+    // Read from SDRAM: the DTCM copy may still be in flight
+    io_printf(IO_BUF, "Inhib gain[%d] = %k\n", n,
+              kbits(region_start(10, address)[n]));
   }
 
   // Load subcomponents
@@ -41,12 +58,21 @@ void c_main(void) {
     return;
   }
   
-  if(!get_pes(region_start(13, address)))
+  // Allocate the PES working buffers now the modulatory filters are known
+  if (!pes_initialise_buffers())
   {
     io_printf(IO_BUF, "[Ensemble] Failed to start.\n");
     return;
   }
 
+  // Merge the routes of all three filter collections into one lookup index
+  input_filter_t *inputs[3] = {&g_input, &g_input_inhibitory,
+                               &g_input_modulatory};
+  if (!routing_index_build(&g_routing_index, inputs, 3)) {
+    io_printf(IO_BUF, "[Ensemble] Failed to start.\n");
+    return;
+  }
+
   // Set up recording
   if (!record_buffer_initialise(&g_ensemble.recd, region_start(15, address),
                                 simulation_ticks, g_ensemble.n_neurons)) {
@@ -54,14 +80,44 @@ void c_main(void) {
     return;
   }
 
+  /* Set up the decimated voltage probe: the membrane voltages are
+   * recorded into region 16, every k-th tick or averaged over k ticks
+   * (see RECORD_DECIMATE_*).
+   */
+  if (!record_buffer_initialise_values(&g_ensemble.recd_voltage,
+                                       region_start(16, address),
+                                       g_ensemble.n_neurons,
+                                       g_ensemble.record_voltage)) {
+    io_printf(IO_BUF, "[Ensemble] Failed to start.\n");
+    return;
+  }
+  if (g_ensemble.recd_voltage.record) {
+    g_ensemble.voltage_frame =
+      nengo_malloc(g_ensemble.n_neurons * sizeof(value_t));
+    if (g_ensemble.voltage_frame == NULL) {
+      io_printf(IO_BUF, "[Ensemble] Failed to malloc voltage frame.\n");
+      return;
+    }
+  }
+
   // Set up routing tables
   io_printf(IO_BUF, "[Ensemble] C_MAIN Configuring system.\n");
   if(leadAp){
     system_lead_app_configured();
   }
 
+  // Set up paced transmission of the decoded output
+  if (!tx_scheduler_initialise(2 * g_n_output_dimensions + 1, 1)) {
+    io_printf(IO_BUF, "[Ensemble] Failed to start.\n");
+    return;
+  }
+
+  // Wait for any outstanding region load before starting
+  init_dma_barrier();
+
   // Setup timer tick, start
   io_printf(IO_BUF, "[Ensemble] C_MAIN Set timer and spin1_start.\n");
+  profiler_init();
   spin1_set_timer_tick(g_ensemble.machine_timestep);
   spin1_start(SYNC_WAIT);
 }
@@ -40,7 +40,7 @@ pes_parameters_t *g_pes_learning_rules = NULL;
 //----------------------------------
 // Global functions
 //----------------------------------
-bool get_pes(address_t address)
+cold_fn bool get_pes(address_t address)
 {
   // Read number of PES learning rules that are configured
   g_num_pes_learning_rules = address[0];
@@ -49,6 +49,15 @@ bool get_pes(address_t address)
   
   if(g_num_pes_learning_rules > 0)
   {
+    // PES modifies decoder rows in place so cannot be combined with
+    // decoders streamed from SDRAM
+    if(g_ensemble.stream_matrices)
+    {
+      io_printf(IO_BUF, "PES learning: not supported with streamed decoders."
+                " Reduce the ensemble size per core.\n");
+      return false;
+    }
+
     // Allocate memory
     MALLOC_FAIL_FALSE(g_pes_learning_rules,
                       g_num_pes_learning_rules * sizeof(pes_parameters_t));
@@ -59,10 +68,83 @@ bool get_pes(address_t address)
     // Display debug
     for(uint32_t l = 0; l < g_num_pes_learning_rules; l++)
     {
-      const pes_parameters_t *parameters = &g_pes_learning_rules[l];
+      pes_parameters_t *parameters = &g_pes_learning_rules[l];
+      parameters->scaled_error = NULL;
       io_printf(IO_BUF, "\tRule %u, Learning rate:%k, Error signal filter index:%u, Decoder output offset:%u\n", 
                l, parameters->learning_rate, parameters->error_signal_filter_index, parameters->decoder_output_offset);
     }
   }
   return true;
 }
+
+bool pes_initialise_buffers(void)
+{
+  for(uint32_t l = 0; l < g_num_pes_learning_rules; l++)
+  {
+    pes_parameters_t *parameters = &g_pes_learning_rules[l];
+    if(parameters->learning_rate > 0.0k)
+    {
+      const filtered_input_buffer_t *filtered_input =
+        g_input_modulatory.filters[parameters->error_signal_filter_index];
+      MALLOC_FAIL_FALSE(parameters->scaled_error,
+                        filtered_input->d_in * sizeof(value_t));
+
+      // Zero so the buffer is safe before the first pes_prepare_tick
+      for(uint d = 0; d < filtered_input->d_in; d++)
+      {
+        parameters->scaled_error[d] = 0.0k;
+      }
+    }
+  }
+  return true;
+}
+
+hot_fn void pes_prepare_tick(void)
+{
+  // Scale each rule's error signal by its learning rate once per tick,
+  // rather than once per spike
+  for(uint32_t l = 0; l < g_num_pes_learning_rules; l++)
+  {
+    const pes_parameters_t *parameters = &g_pes_learning_rules[l];
+    if(parameters->learning_rate > 0.0k)
+    {
+      const filtered_input_buffer_t *filtered_input =
+        g_input_modulatory.filters[parameters->error_signal_filter_index];
+      const value_t *filtered_error_signal = filtered_input->filtered;
+
+      for(uint d = 0; d < filtered_input->d_in; d++)
+      {
+        parameters->scaled_error[d] =
+          parameters->learning_rate * filtered_error_signal[d];
+      }
+    }
+  }
+}
+
+hot_fn void pes_apply_spikes(uint n_start)
+{
+  // Sweep the decoder rows of the spiking neurons once per rule, adding
+  // the precomputed scaled error vector to each
+  for(uint32_t l = 0; l < g_num_pes_learning_rules; l++)
+  {
+    const pes_parameters_t *parameters = &g_pes_learning_rules[l];
+    if(parameters->learning_rate > 0.0k)
+    {
+      const filtered_input_buffer_t *filtered_input =
+        g_input_modulatory.filters[parameters->error_signal_filter_index];
+      const value_t *scaled_error = parameters->scaled_error;
+
+      for(uint s = 0; s < g_ensemble.n_spikes; s++)
+      {
+        value_t *decoder_vector =
+          neuron_decoder_vector(n_start + g_ensemble.spike_list[s]) +
+          parameters->decoder_output_offset;
+
+        for(uint d = 0; d < filtered_input->d_in; d++)
+        {
+          decoder_vector[d] += scaled_error[d];
+        }
+      }
+    }
+  }
+}
@@ -34,6 +34,9 @@ typedef struct pes_parameters_t
   
   // Offset into decoder to apply PES
   uint32_t decoder_output_offset;
+
+  // Error signal scaled by the learning rate, computed once per tick
+  value_t *scaled_error;
 } pes_parameters_t;
 
 //----------------------------------
@@ -42,36 +45,6 @@ typedef struct pes_parameters_t
 extern uint32_t g_num_pes_learning_rules;
 extern pes_parameters_t *g_pes_learning_rules;
 
-//----------------------------------
-// Inline functions
-//----------------------------------
-/**
-* \brief When using non-filtered activity, applies PES when neuron spikes
-*/
-static inline void pes_neuron_spiked(uint n)
-{
-  // Loop through all the learning rules
-  for(uint32_t l = 0; l < g_num_pes_learning_rules; l++)
-  {
-    const pes_parameters_t *parameters = &g_pes_learning_rules[l];
-    if(parameters->learning_rate > 0.0k)
-    {
-      // Extract error signal vector from 
-      const filtered_input_buffer_t *filtered_input = g_input_modulatory.filters[parameters->error_signal_filter_index];
-      const value_t *filtered_error_signal = filtered_input->filtered;
-      
-      // Get filtered activity of this neuron and it's decoder vector
-      value_t *decoder_vector = neuron_decoder_vector(n);
-      
-      // Loop through output dimensions and apply PES to decoder values offset by output offset
-      for(uint d = 0; d < filtered_input->d_in; d++) 
-      {
-        decoder_vector[d + parameters->decoder_output_offset] += (parameters->learning_rate * filtered_error_signal[d]);
-      }
-    }
-  }
-}
-
 //----------------------------------
 // Functions
 //----------------------------------
@@ -81,6 +54,26 @@ static inline void pes_neuron_spiked(uint n)
 */
 bool get_pes(address_t address);
 
+/**
+* \brief Allocate the per-rule scaled error buffers.  Must be called after
+* the modulatory input filters have been loaded, as the buffers match the
+* dimensionality of each rule's error signal filter.
+*/
+bool pes_initialise_buffers(void);
+
+/**
+* \brief Compute each rule's learning_rate * error vector for this tick.
+* Call once per tick, after the modulatory filters have been stepped.
+*/
+void pes_prepare_tick(void);
+
+/**
+* \brief Apply the PES updates for every spike recorded in the ensemble
+* spike list, sweeping the affected decoder rows once per rule.
+* \param n_start Index of the first neuron in the current block
+*/
+void pes_apply_spikes(uint n_start);
+
 /** @} */
 
 #endif  // __ENSEMBLE_PES_H__
\ No newline at end of file
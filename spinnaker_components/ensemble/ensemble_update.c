@@ -16,32 +16,39 @@
 
 uint lfsr = 1;                   //!< LFSR for spike perturbation
 
-void ensemble_update(uint ticks, uint arg1) {
-  use(arg1);
-  if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
-    spin1_exit(0);
-  }
+/* Tick overrun tracking.  If an update exceeds the machine timestep the
+ * deferred TIMER_TICK callbacks are eventually dropped and the `ticks`
+ * argument jumps; we detect the jump against a local counter rather than
+ * letting the simulation silently skew.  While under pressure the cheapest
+ * non-essential work (the bitmap recording flush, whose frame slot is
+ * reserved whether or not it is written) is shed for a few ticks.
+ */
+#define OVERRUN_BACKOFF_TICKS 10
 
-  // Prepare the recorder
-  record_buffer_prepare(&g_ensemble.recd);
+static uint expected_ticks = 0;  //!< Ticks this core has actually simulated
+static uint overrun_count = 0;   //!< Total timer ticks missed
+static uint degrade_remaining = 0;  //!< Ticks of degraded service left
 
-  // Values used below
+/** \brief Simulate a contiguous block of neurons.
+ *
+ * Spiking neurons are appended to the spike list rather than decoded
+ * inline; the decode is performed as a separate sequential pass over the
+ * decoder rows by decode_spikes().
+ *
+ *  \param n_start Index of the first neuron in the block
+ *  \param n_count Number of neurons in the block
+ *  \param encoder_rows Encoder rows for the block (row 0 = neuron n_start)
+ *  \param inhibitory_input Summed inhibitory input for this tick
+ */
+static hot_fn void simulate_neurons(uint n_start, uint n_count,
+                             value_t *encoder_rows,
+                             value_t inhibitory_input) {
   current_t i_membrane;
   voltage_t v_delta, v_voltage;
-  value_t inhibitory_input = 0;
 
-  // Filter inputs, updating accumulator for excitary and inhibitary inputs
-  input_filter_step(&g_input, true);
-  input_filter_step(&g_input_inhibitory, true);
-  input_filter_step(&g_input_modulatory, false);
-
-  // Compute the inhibition
-  for (uint d = 0; d < g_ensemble.n_inhib_dims; d++) {
-    inhibitory_input += g_input_inhibitory.input[d];
-  }
+  for( uint i = 0; i < n_count; i++ ) {
+    uint n = n_start + i;
 
-  // Perform neuron updates
-  for( uint n = 0; n < g_ensemble.n_neurons; n++ ) {
     // If this neuron is refractory then skip any further processing
     if( neuron_refractory( n ) != 0 ) {
       decrement_neuron_refractory( n );
@@ -53,8 +60,9 @@ void ensemble_update(uint ticks, uint arg1) {
                   inhibitory_input * g_ensemble.inhib_gain[n]);
 
     // Encode the input and add to the membrane current
+    value_t *encoder = &encoder_rows[i * g_input.n_dimensions];
     for( uchar d = 0; d < g_input.n_dimensions; d++ ) {
-      i_membrane += neuron_encoder(n, d) * g_ensemble.input[d];
+      i_membrane += encoder[d] * g_ensemble.input[d];
     }
 
     v_voltage = neuron_voltage(n);
@@ -88,35 +96,277 @@ void ensemble_update(uint ticks, uint arg1) {
       }
       lfsr = ((lfsr >> 1) ^ (~lfsr & 0xB400));
 
-      // Update the output values
-      for( uint d = 0; d < g_n_output_dimensions; d++ ) {
-        /* io_printf( IO_STD, "[%d] = %.3k (0x%08x)",
-          d, neuron_decoder(n,d), neuron_decoder(n,d) ); */
-        g_ensemble.output[d] += neuron_decoder( n, d );
-      }
-      //io_printf( IO_STD, "\n" );
+      // Append to the spike list for the batched decode pass
+      g_ensemble.spike_list[g_ensemble.n_spikes++] = i;
 
       // Record that the spike occurred
       record_spike(&g_ensemble.recd, n);
+    }
+  }
+}
+
+/** \brief Decode the spikes accumulated for one block of neurons.
+ *
+ * Streams the decoder rows of just the spiking neurons sequentially,
+ * rather than interleaving row reads with the neuron state updates, and
+ * feeds the PES learning rules from the same list.
+ *
+ *  \param n_start Index of the first neuron in the block
+ *  \param decoder_rows Decoder rows for the block (row 0 = neuron n_start)
+ */
+static hot_fn void decode_spikes(uint n_start, value_t *decoder_rows) {
+  for (uint s = 0; s < g_ensemble.n_spikes; s++) {
+    uint i = g_ensemble.spike_list[s];
+    uint n = n_start + i;
+
+    if (g_ensemble.decoders_banded) {
+      // Iterate only the nonzero span of the packed decoder row
+      value_t *decoder = &decoder_rows[g_ensemble.decoder_offset[n]];
+      uint start = g_ensemble.decoder_start[n];
+      uint length = g_ensemble.decoder_length[n];
+      for (uint d = 0; d < length; d++) {
+        g_ensemble.output[start + d] += decoder[d];
+      }
+    } else {
+      value_t *decoder = &decoder_rows[i * g_n_output_dimensions];
+      for (uint d = 0; d < g_n_output_dimensions; d++) {
+        g_ensemble.output[d] += decoder[d];
+      }
+    }
+  }
+
+  // Apply the batched PES updates for the same spikes
+  pes_apply_spikes(n_start);
+
+  g_ensemble.n_spikes = 0;
+}
+
+/** \brief Start the DMA of one block of encoder and decoder rows.
+ */
+static void fetch_matrix_block(uint block, uint buffer) {
+  uint n_start = block * g_ensemble.block_rows;
+  uint n_rows = g_ensemble.n_neurons - n_start;
+  if (n_rows > g_ensemble.block_rows) {
+    n_rows = g_ensemble.block_rows;
+  }
+
+  /* Publish the transfer count with a single store before either DMA is
+   * issued: the matching decrements run in the DMA-complete callback, so
+   * incrementing between the transfers would race a completion and could
+   * lose an update, hanging the drain loop.  The caller has drained the
+   * previous block, so the counter is zero on entry.
+   */
+  uint n_transfers = 0;
+  if (g_input.n_dimensions > 0) {
+    n_transfers++;
+  }
+  if (g_n_output_dimensions > 0) {
+    n_transfers++;
+  }
+  g_stream_dma_pending = n_transfers;
+
+  if (g_input.n_dimensions > 0) {
+    spin1_dma_transfer(0,
+        &g_ensemble.encoders_sdram[n_start * g_input.n_dimensions],
+        g_ensemble.encoder_blocks[buffer], DMA_READ,
+        n_rows * g_input.n_dimensions * sizeof(value_t));
+  }
+  if (g_n_output_dimensions > 0) {
+    spin1_dma_transfer(0,
+        &g_ensemble.decoders_sdram[n_start * g_n_output_dimensions],
+        g_ensemble.decoder_blocks[buffer], DMA_READ,
+        n_rows * g_n_output_dimensions * sizeof(value_t));
+  }
+}
+
+hot_fn void ensemble_update(uint ticks, uint arg1) {
+  use(arg1);
+  if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    if (overrun_count > 0) {
+      io_printf(IO_BUF, "[Ensemble] %d timer ticks were missed.\n",
+                overrun_count);
+    }
+    sark.vcpu->user2 = overrun_count;
+    record_buffer_close(&g_ensemble.recd);
+    profiler_finalise();
+    spin1_exit(0);
+  }
 
-      // Notify PES that neuron has spiked
-      pes_neuron_spiked(n);
+  // Detect ticks lost to an overrunning previous update
+  expected_ticks++;
+  if (ticks > expected_ticks) {
+    if (overrun_count == 0) {
+      io_printf(IO_BUF, "[Ensemble] Tick overrun at t = %d.\n", ticks);
     }
+    overrun_count += ticks - expected_ticks;
+    expected_ticks = ticks;
+    degrade_remaining = OVERRUN_BACKOFF_TICKS;
+  }
+
+  // Prepare the recorder
+  record_buffer_prepare(&g_ensemble.recd);
+
+  profiler_start(PROFILER_PHASE_INPUT);
+  value_t inhibitory_input = 0;
+
+  if (g_ensemble.flags & ENSEMBLE_FLAG_SHARED_INPUT_FOLLOW) {
+    /* Follower core of a multi-core ensemble: spin until the head core
+     * publishes this tick's filtered input, then read the input vector
+     * and the summed inhibition from the SysRAM block.  See
+     * shared_input_t for the publication ordering.
+     */
+    shared_input_t *shared = g_ensemble.shared_input;
+    static uint last_sequence = 0;
+    while (shared->sequence == last_sequence) {
+      continue;
+    }
+    last_sequence = shared->sequence;
+
+    spin1_memcpy(g_ensemble.input, (void *) shared->values,
+                 g_input.n_dimensions * sizeof(value_t));
+    inhibitory_input = shared->values[shared->n_dimensions];
+  } else {
+    // Route and accumulate the packets which arrived since the last tick
+    uint key, payload;
+    while (packet_queue_pop(&g_packet_queue, &key, &payload)) {
+      if (!routing_index_mcpl_rx(&g_routing_index, key, payload)) {
+        io_printf(IO_BUF, "[Ensemble] Unknown key %08x\n", key);
+      }
+    }
+
+    // Filter inputs, updating accumulator for excitary and inhibitary inputs
+    input_filter_step(&g_input, true);
+    input_filter_step(&g_input_inhibitory, true);
+    input_filter_step(&g_input_modulatory, false);
+
+    // Scale each PES rule's error signal once, ready for the decode pass
+    pes_prepare_tick();
+
+    // Compute the inhibition
+    for (uint d = 0; d < g_ensemble.n_inhib_dims; d++) {
+      inhibitory_input += g_input_inhibitory.input[d];
+    }
+
+    if (g_ensemble.flags & ENSEMBLE_FLAG_SHARED_INPUT_HEAD) {
+      // Publish the filtered input for the follower cores; the sequence
+      // word is written last so a follower never reads a partial vector
+      shared_input_t *shared = g_ensemble.shared_input;
+      spin1_memcpy((void *) shared->values, g_ensemble.input,
+                   g_input.n_dimensions * sizeof(value_t));
+      shared->values[shared->n_dimensions] = inhibitory_input;
+      shared->sequence++;
+    }
+  }
+
+  profiler_end(PROFILER_PHASE_INPUT);
+
+  // Perform neuron updates
+  if (!g_ensemble.stream_matrices) {
+    // Matrices resident in DTCM: simulate all neurons as one block
+    profiler_start(PROFILER_PHASE_UPDATE);
+    simulate_neurons(0, g_ensemble.n_neurons, g_ensemble.encoders,
+                     inhibitory_input);
+    profiler_end(PROFILER_PHASE_UPDATE);
+
+    profiler_start(PROFILER_PHASE_DECODE);
+    decode_spikes(0, g_ensemble.decoders);
+    profiler_end(PROFILER_PHASE_DECODE);
+  } else {
+    /* Matrices resident in SDRAM: walk the neurons in blocks, DMAing the
+     * next block of encoder and decoder rows into the spare buffer while
+     * the current block is simulated.
+     */
+    uint n_blocks = (g_ensemble.n_neurons + g_ensemble.block_rows - 1) /
+                    g_ensemble.block_rows;
+    uint buffer = 0;
+
+    // Synchronously fetch the first block
+    fetch_matrix_block(0, buffer);
+
+    for (uint block = 0; block < n_blocks; block++) {
+      // Wait for the current block to arrive
+      while (g_stream_dma_pending > 0) {
+        spin1_wfi();
+      }
+
+      // Prefetch the next block into the other buffer
+      if (block + 1 < n_blocks) {
+        fetch_matrix_block(block + 1, buffer ^ 1);
+      }
+
+      uint n_start = block * g_ensemble.block_rows;
+      uint n_count = g_ensemble.n_neurons - n_start;
+      if (n_count > g_ensemble.block_rows) {
+        n_count = g_ensemble.block_rows;
+      }
+
+      profiler_start(PROFILER_PHASE_UPDATE);
+      simulate_neurons(n_start, n_count, g_ensemble.encoder_blocks[buffer],
+                       inhibitory_input);
+      profiler_end(PROFILER_PHASE_UPDATE);
+
+      profiler_start(PROFILER_PHASE_DECODE);
+      decode_spikes(n_start, g_ensemble.decoder_blocks[buffer]);
+      profiler_end(PROFILER_PHASE_DECODE);
+      buffer ^= 1;
+    }
+  }
+
+  /* Record the voltage probe before the transmission phase.  This runs
+   * even while shedding load after an overrun: the host decodes the value
+   * frames as a fixed cadence, so a skipped tick would shift the whole
+   * trace in time.
+   */
+  if (g_ensemble.recd_voltage.record) {
+    for (uint n = 0; n < g_ensemble.n_neurons; n++) {
+      g_ensemble.voltage_frame[n] = neuron_voltage(n);
+    }
+    record_buffer_record_values(&g_ensemble.recd_voltage,
+                                g_ensemble.voltage_frame);
   }
 
   // Transmit decoded Ensemble representation
-  for (uint output_index = 0; output_index < g_n_output_dimensions;
-       output_index++) {
-    spin1_send_mc_packet(
-      gp_output_keys[output_index],
-      bitsk(gp_output_values[output_index]),
-      WITH_PAYLOAD
-    );
-    gp_output_values[output_index] = 0;
-
-    spin1_delay_us(1);
+  profiler_start(PROFILER_PHASE_TRANSMIT);
+  if (g_ensemble.flags & ENSEMBLE_FLAG_PACKED_OUTPUT) {
+    // Two adjacent dimensions share one payload, halving the packet count
+    for (uint output_index = 0; output_index < g_n_output_dimensions;
+         output_index += 2) {
+      value_t low = gp_output_values[output_index];
+      value_t high = (output_index + 1 < g_n_output_dimensions) ?
+                     gp_output_values[output_index + 1] : 0.0k;
+
+      tx_scheduler_send(gp_output_keys[output_index],
+                        dual_value_pack(low, high));
+      gp_output_values[output_index] = 0;
+      if (output_index + 1 < g_n_output_dimensions) {
+        gp_output_values[output_index + 1] = 0;
+      }
+    }
+  } else {
+    for (uint output_index = 0; output_index < g_n_output_dimensions;
+         output_index++) {
+      tx_scheduler_send(gp_output_keys[output_index],
+                        bitsk(gp_output_values[output_index]));
+      gp_output_values[output_index] = 0;
+    }
   }
+  profiler_end(PROFILER_PHASE_TRANSMIT);
 
-  // Flush the recording buffer
-  record_buffer_flush(&g_ensemble.recd);
+  /* Flush the recording buffer.  While shedding load after an overrun the
+   * flush DMA may be skipped, but only in the bitmap format, where
+   * record_buffer_prepare has already advanced the SDRAM pointer and the
+   * frame timeline stays aligned.  Index frames are emitted (and the
+   * accumulation bitmap cleared) by the flush itself, so skipping it
+   * there would drop a frame and fold its spikes into the next one.
+   */
+  bool shed_flush = degrade_remaining > 0 &&
+                    g_ensemble.recd.format == RECORD_FORMAT_BITMAP;
+  if (degrade_remaining > 0) {
+    degrade_remaining--;
+  }
+  if (!shed_flush) {
+    profiler_start(PROFILER_PHASE_RECORD);
+    record_buffer_flush(&g_ensemble.recd);
+    profiler_end(PROFILER_PHASE_RECORD);
+  }
 }
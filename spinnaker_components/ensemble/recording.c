@@ -7,16 +7,171 @@ bool record_buffer_initialise(recording_buffer_t *buffer, address_t region,
   buffer->n_frames = n_frames;
   buffer->_sdram_start = (uint *) region;
   buffer->_sdram_current = (uint *) region;
+  buffer->words_written = 0;
 
   buffer->current_frame = UINT32_MAX;  // To cause overflow on first tick
 
-  // Create the local buffer
-  MALLOC_FAIL_FALSE(buffer->buffer, buffer->frame_length * sizeof(uint));
+  // Create the local ping-pong buffers
+  for (uint b = 0; b < 2; b++) {
+    MALLOC_FAIL_FALSE(buffer->_buffers[b],
+                      buffer->frame_length * sizeof(uint));
 
-  // Zero the local buffers
+    // Zero the local buffers
+    for (uint i = 0; i < buffer->frame_length; i++) {
+      buffer->_buffers[b][i] = 0x0;
+    }
+  }
+
+  if (buffer->format == RECORD_FORMAT_INDICES) {
+    /* Compressed frames are staged in their own ping-pong buffers, sized
+     * for the worst case (header plus bitmap fallback).  Frame data
+     * starts one word into the region, after the length word.
+     */
+    for (uint b = 0; b < 2; b++) {
+      MALLOC_FAIL_FALSE(buffer->_index_buffers[b],
+                        (buffer->frame_length + 1) * sizeof(uint));
+    }
+    buffer->_sdram_current = buffer->_sdram_start + 1;
+
+    io_printf(IO_BUF, "[Recording] Spike-index format.\n");
+  }
+
+  buffer->_current = 0;
+  buffer->buffer = buffer->_buffers[0];
+
+  return true;
+}
+
+void record_buffer_flush(recording_buffer_t *buffer) {
+  if (buffer->record) {
+    if (buffer->format == RECORD_FORMAT_INDICES) {
+      /* Compress the bitmap into a spike-index frame: a count word then
+       * the spiking neuron indices packed two per word.  If more spikes
+       * occurred than fit in one frame, fall back to a flagged bitmap.
+       */
+      uint *out = buffer->_index_buffers[buffer->_current];
+      uint max_spikes = 2 * buffer->frame_length;
+      uint count = 0;
+      uint words;
+
+      for (uint w = 0; w < buffer->frame_length && count <= max_spikes; w++) {
+        uint word = buffer->buffer[w];
+        for (uint b = 0; word != 0; b++, word >>= 1) {
+          if (word & 0x1) {
+            if (count == max_spikes) {
+              // Too many spikes for an index frame
+              count++;
+              break;
+            }
+            uint n = (w << 5) + b;
+            if (count & 0x1) {
+              out[1 + (count >> 1)] |= n << 16;
+            } else {
+              out[1 + (count >> 1)] = n;
+            }
+            count++;
+          }
+        }
+      }
+
+      if (count > max_spikes) {
+        // Bitmap fallback, flagged in the header word
+        out[0] = RECORD_FRAME_BITMAP;
+        spin1_memcpy(&out[1], buffer->buffer,
+                     buffer->frame_length * sizeof(uint));
+        words = 1 + buffer->frame_length;
+      } else {
+        out[0] = count;
+        words = 1 + ((count + 1) >> 1);
+      }
+
+      spin1_dma_transfer(RECORDING_DMA_TAG, buffer->_sdram_current, out,
+                         DMA_WRITE, words * sizeof(uint));
+      buffer->_sdram_current += words;
+      buffer->words_written += words;
+    } else {
+      spin1_dma_transfer(RECORDING_DMA_TAG, buffer->_sdram_current,
+                         buffer->buffer, DMA_WRITE,
+                         buffer->frame_length * sizeof(uint));
+    }
+
+    buffer->_current ^= 1;
+    buffer->buffer = buffer->_buffers[buffer->_current];
+  }
+
+  // Empty the (new) buffer
   for (uint i = 0; i < buffer->frame_length; i++) {
-    buffer->buffer[i] = 0x0;
+    buffer->buffer[i] = 0;
+  }
+}
+
+bool record_buffer_initialise_values(recording_buffer_t *buffer,
+                                     address_t region, uint frame_length,
+                                     uint config) {
+  buffer->format = RECORD_FORMAT_VALUES;
+  buffer->decimation = config & RECORD_DECIMATE_MASK;
+  buffer->average = (config & RECORD_DECIMATE_AVERAGE) != 0;
+  buffer->record = (buffer->decimation != 0);
+
+  buffer->frame_length = frame_length;
+  buffer->_sdram_start = (uint *) region;
+  buffer->_sdram_current = (uint *) region;
+  buffer->words_written = 0;
+  buffer->_decim_count = 0;
+
+  if (!buffer->record) {
+    return true;
   }
 
+  buffer->_decim_recip = kbits((1 << 15) / buffer->decimation);
+
+  for (uint b = 0; b < 2; b++) {
+    MALLOC_FAIL_FALSE(buffer->_buffers[b],
+                      buffer->frame_length * sizeof(uint));
+    for (uint i = 0; i < buffer->frame_length; i++) {
+      buffer->_buffers[b][i] = 0x0;
+    }
+  }
+  buffer->_current = 0;
+  buffer->buffer = buffer->_buffers[0];
+
+  io_printf(IO_BUF, "[Recording] Value format, %d values every %d ticks%s.\n",
+            frame_length, buffer->decimation,
+            buffer->average ? " (averaged)" : "");
+
   return true;
 }
+
+void record_buffer_record_values(recording_buffer_t *buffer,
+                                 value_t *values) {
+  if (!buffer->record) {
+    return;
+  }
+
+  value_t *frame = (value_t *) buffer->buffer;
+  if (buffer->average) {
+    for (uint i = 0; i < buffer->frame_length; i++) {
+      frame[i] += values[i];
+    }
+  }
+
+  buffer->_decim_count++;
+  if (buffer->_decim_count < buffer->decimation) {
+    return;
+  }
+  buffer->_decim_count = 0;
+
+  // Complete the frame: scale the accumulated mean, or take this sample
+  if (buffer->average) {
+    for (uint i = 0; i < buffer->frame_length; i++) {
+      frame[i] *= buffer->_decim_recip;
+    }
+  } else {
+    spin1_memcpy(frame, values, buffer->frame_length * sizeof(value_t));
+  }
+
+  // Flush swaps the ping-pong buffers and zeroes the new one
+  record_buffer_flush(buffer);
+  buffer->_sdram_current += buffer->frame_length;
+  buffer->words_written += buffer->frame_length;
+}
@@ -1,5 +1,5 @@
 /*!
- * \brief Spike recording
+ * \brief Spike and value recording
  *
  * \author Andrew Mundy <mundya@cs.man.ac.uk>
  *
@@ -15,13 +15,55 @@
 #include "spin1_api.h"
 #include "common-typedefs.h"
 #include "nengo-common.h"
+#include "nengo_typedefs.h"
+
+//! DMA tag used for recording buffer writes to SDRAM
+#define RECORDING_DMA_TAG 1
+
+/* Recording formats, given by the record_spikes word of the system region.
+ *
+ * The bitmap format writes a fixed n_neurons / 32 word frame per tick.
+ * The index format writes a variable-length frame per tick: a header word
+ * holding the spike count followed by the spiking neuron indices packed
+ * two (16-bit) per word; a frame with more spikes than would fit falls
+ * back to a bitmap, flagged by the top bit of its header.  The region
+ * starts with one word giving the total words of frame data written,
+ * filled in when the simulation ends.
+ */
+#define RECORD_FORMAT_NONE 0     //!< Recording disabled
+#define RECORD_FORMAT_BITMAP 1   //!< One bitmap frame per tick
+#define RECORD_FORMAT_INDICES 2  //!< Spike-index list frames
+#define RECORD_FORMAT_VALUES 3   //!< Fixed-point value frames
+
+/* Value recording configuration word (the record_voltage word of the
+ * ensemble system region).  The low bits give the decimation factor: one
+ * frame is written to SDRAM every k ticks, either the k-th sample or
+ * (when the average flag is set) the mean of the k ticks.  Zero disables
+ * the recorder.
+ */
+#define RECORD_DECIMATE_MASK 0x0000ffff  //!< Decimation factor k
+#define RECORD_DECIMATE_AVERAGE 0x80000000  //!< Average over the k ticks
+
+//! Flags a bitmap fallback frame in the index format
+#define RECORD_FRAME_BITMAP 0x80000000
 
 typedef struct _recording_buffer_t {
-  uint *buffer;         //!< The buffer to write to
+  uint *buffer;         //!< The buffer currently being written
+  uint *_buffers[2];    //!< Ping-pong frame buffers
+  uint _current;        //!< Index of the buffer currently being written
   uint frame_length;    //!< Size of 1 frame of the buffer (in words)
   uint n_frames;        //!< Length of the buffer in frames (= n_ticks)
 
   bool record;          //!< Whether or not to record the data in the buffer
+  uint format;          //!< Recording format, see RECORD_FORMAT_*
+
+  uint *_index_buffers[2];  //!< Ping-pong compressed frame buffers
+  uint words_written;       //!< Total words of frame data written to SDRAM
+
+  uint decimation;      //!< Ticks per recorded frame (value format)
+  bool average;         //!< Record the mean of each k ticks, not a sample
+  uint _decim_count;    //!< Ticks accumulated towards the current frame
+  value_t _decim_recip; //!< 1 / decimation
 
   uint current_frame;   //!< Current frame number
 
@@ -34,13 +76,33 @@ typedef struct _recording_buffer_t {
 bool record_buffer_initialise(recording_buffer_t *buffer, address_t region,
                               uint n_frames, uint n_neurons);
 
+/*!\brief Initialise a buffer recording fixed-point value frames.
+ *
+ * One frame of frame_length values is written to SDRAM every `decimation`
+ * ticks; config is a RECORD_DECIMATE_* word from the system region and a
+ * zero decimation factor disables the recorder entirely.
+ */
+bool record_buffer_initialise_values(recording_buffer_t *buffer,
+                                     address_t region, uint frame_length,
+                                     uint config);
+
+/*!\brief Present one tick's values to a value-format recorder.
+ *
+ * Values are sampled or averaged according to the decimation
+ * configuration; when a frame completes it is flushed to SDRAM as a DMA
+ * in the manner of record_buffer_flush.
+ */
+void record_buffer_record_values(recording_buffer_t *buffer,
+                                 value_t *values);
+
 /*!\brief Prepare buffer for writing.
  *
- * If recording is in use the pointer to the current address in SDRAM will be
- * advanced by one recording frame.
+ * In the bitmap format the pointer to the current address in SDRAM is
+ * advanced by one fixed-length frame; index format frames are variable
+ * length, so there the pointer is advanced by the flush itself.
  */
 static inline void record_buffer_prepare(recording_buffer_t *buffer) {
-  if (buffer->record) {
+  if (buffer->record && buffer->format == RECORD_FORMAT_BITMAP) {
     buffer->_sdram_current += buffer->frame_length;
   }
 }
@@ -48,18 +110,25 @@ static inline void record_buffer_prepare(recording_buffer_t *buffer) {
 /*!\brief Flush the current buffer.
  *
  * The contents of the buffer will be appended to the recording region in
- * SDRAM, but only if recording is in use.
+ * SDRAM, but only if recording is in use.  The write is issued as a DMA
+ * and the buffers swapped, so the copy overlaps the next tick's neuron
+ * update rather than blocking at the end of this one.
+ *
+ * In the index format the bitmap is first compressed into a spike-index
+ * frame (see RECORD_FORMAT_INDICES), so a mostly-quiet ensemble writes a
+ * few words per tick rather than a full bitmap.
  */
-static inline void record_buffer_flush(recording_buffer_t *buffer) {
-  // Copy the current buffer into SDRAM
-  if (buffer->record) {
-    spin1_memcpy(buffer->_sdram_current, buffer->buffer,
-                 buffer->frame_length * sizeof(uint));
-  }
+void record_buffer_flush(recording_buffer_t *buffer);
 
-  // Empty the buffer
-  for (uint i = 0; i < buffer->frame_length; i++) {
-    buffer->buffer[i] = 0;
+/*!\brief Finish recording, completing the region header.
+ *
+ * In the index format the first word of the region receives the total
+ * number of frame data words written, which the host uses to bound its
+ * readback.  Call once, immediately before exiting.
+ */
+static inline void record_buffer_close(recording_buffer_t *buffer) {
+  if (buffer->record && buffer->format == RECORD_FORMAT_INDICES) {
+    buffer->_sdram_start[0] = buffer->words_written;
   }
 }
 
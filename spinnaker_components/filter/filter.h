@@ -3,6 +3,13 @@
  * \brief A component which filters its input and provides output of that
  *        filtered value at regular intervals.
  *
+ * A large transform may be partitioned by rows across several cores:
+ * each instance receives its own row slice of the transform and of the
+ * output keys, with the full input filter configuration, so the cores
+ * compute and transmit disjoint output slices of the same product in
+ * parallel.  The partitioning is performed on the host; nothing here
+ * distinguishes a slice from a whole transform.
+ *
  * \copyright Advanced Processor Technologies, School of Computer Science,
  *   University of Manchester
  * \copyright Computational Neuroscience Research Group, Centre for
@@ -15,10 +22,25 @@
 
 #include "spin1_api.h"
 #include "input_filter.h"
+#include "packet_queue.h"
+#include "profiler.h"
+#include "tx_scheduler.h"
 #include "nengo-common.h"
 
 #include "common-impl.h"
 
+/** \brief Storage formats for the filter transform.
+ *
+ * The format is detected when the transform is loaded: identity, scalar
+ * and diagonal transforms collapse to one multiply per dimension, and
+ * mostly-zero transforms are held in compressed sparse row form.
+ */
+typedef enum transform_format {
+  TRANSFORM_DENSE = 0,  //!< Full size_out x size_in matrix
+  TRANSFORM_DIAGONAL,   //!< Diagonal only, size_out values
+  TRANSFORM_SPARSE,     //!< Compressed sparse rows
+} transform_format_t;
+
 /** \brief Shared filter parameters.
   */
 typedef struct filter_parameters {
@@ -27,12 +49,19 @@ typedef struct filter_parameters {
 
   uint interpacket_pause;  //!< Delay in usecs between transmitting packets
 
+  value_t transmit_epsilon; //!< Change below which a dimension is not resent
+  uint refresh_interval;    //!< Transmissions between full refreshes (0 = off)
+
   uint size_in, size_out;  //!< The size of data to expect, to output
 
-  value_t *transform;      //!< A size_in-by-size_out transform for the data
+  value_t *transform;      //!< Transform values (layout set by format)
+  transform_format_t transform_format;  //!< Storage format of the transform
+  uint *sparse_row_ptr;    //!< CSR row pointers, size_out + 1 entries
+  uint *sparse_cols;       //!< CSR column indices, one per nonzero
 
   value_t *input;          //!< Input buffer
   value_t *output;         //!< Output buffer
+  value_t *last_output;    //!< Value last transmitted per dimension
   uint *keys;              //!< Output keys
 } filter_parameters_t;
 extern filter_parameters_t g_filter; //!< Global parameters
@@ -2,38 +2,101 @@
 
 filter_parameters_t g_filter;
 uint delay_remaining;
+uint refresh_remaining;
 input_filter_t g_input;
+packet_queue_t g_packet_queue;
 
-void filter_update(uint ticks, uint arg1) {
+hot_fn void filter_update(uint ticks, uint arg1) {
   use(arg1);
   if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    tx_scheduler_flush();
+    profiler_finalise();
     spin1_exit(0);
   }
 
+  // Route and accumulate the packets which arrived since the last tick
+  profiler_start(PROFILER_PHASE_INPUT);
+  uint key, payload;
+  while (packet_queue_pop(&g_packet_queue, &key, &payload)) {
+    if (!input_filter_mcpl_rx(&g_input, key, payload)) {
+      io_printf(IO_BUF, "[Filter] Unknown key %08x\n", key);
+    }
+  }
+
   // Update the filters
   input_filter_step(&g_input, true);
+  profiler_end(PROFILER_PHASE_INPUT);
 
   // Apply the transform to the input to get the output
-  for (uint j = 0; j < g_filter.size_out; j++) {
-    g_filter.output[j] = 0;
+  profiler_start(PROFILER_PHASE_UPDATE);
+  switch (g_filter.transform_format) {
+    case TRANSFORM_DIAGONAL:
+      // One multiply per dimension
+      for (uint j = 0; j < g_filter.size_out; j++) {
+        g_filter.output[j] = g_filter.transform[j] * g_filter.input[j];
+      }
+      break;
 
-    for (uint k = 0; k < g_filter.size_in; k++) {
-      g_filter.output[j] += g_filter.transform[j*g_filter.size_in + k] *
-                            g_filter.input[k];
-    }
+    case TRANSFORM_SPARSE:
+      // Multiply-accumulate only the nonzero entries of each row
+      for (uint j = 0; j < g_filter.size_out; j++) {
+        g_filter.output[j] = 0;
+
+        for (uint i = g_filter.sparse_row_ptr[j];
+             i < g_filter.sparse_row_ptr[j + 1]; i++) {
+          g_filter.output[j] += g_filter.transform[i] *
+                                g_filter.input[g_filter.sparse_cols[i]];
+        }
+      }
+      break;
+
+    default:
+      for (uint j = 0; j < g_filter.size_out; j++) {
+        g_filter.output[j] = 0;
+
+        for (uint k = 0; k < g_filter.size_in; k++) {
+          g_filter.output[j] += g_filter.transform[j*g_filter.size_in + k] *
+                                g_filter.input[k];
+        }
+      }
+      break;
   }
+  profiler_end(PROFILER_PHASE_UPDATE);
 
   // Increment the counter and transmit if necessary
   delay_remaining--;
   if(delay_remaining == 0) {
     delay_remaining = g_filter.transmission_delay;
 
-    uint val = 0x0000;
+    /* Dirty tracking: skip dimensions whose output has not moved by more
+     * than the epsilon since they were last sent.  Every refresh_interval
+     * transmissions all dimensions are sent regardless, so downstream
+     * cores recover from any lost packet.
+     */
+    bool full_refresh = (g_filter.refresh_interval == 0);
+    if (!full_refresh && --refresh_remaining == 0) {
+      full_refresh = true;
+      refresh_remaining = g_filter.refresh_interval;
+    }
+
+    profiler_start(PROFILER_PHASE_TRANSMIT);
     for(uint d = 0; d < g_filter.size_out; d++) {
-      val = bitsk(g_filter.output[d]);
-      spin1_send_mc_packet(g_filter.keys[d], val, WITH_PAYLOAD);
-      spin1_delay_us(g_filter.interpacket_pause);
+      value_t value = g_filter.output[d];
+
+      if (!full_refresh) {
+        value_t delta = value - g_filter.last_output[d];
+        if (delta < 0.0k) {
+          delta = -delta;
+        }
+        if (delta <= g_filter.transmit_epsilon) {
+          continue;
+        }
+      }
+
+      tx_scheduler_send(g_filter.keys[d], bitsk(value));
+      g_filter.last_output[d] = value;
     }
+    profiler_end(PROFILER_PHASE_TRANSMIT);
   }
 }
 
@@ -43,11 +106,17 @@ bool data_system(address_t addr) {
   g_filter.machine_timestep = addr[2];
   g_filter.transmission_delay = addr[3];
   g_filter.interpacket_pause = addr[4];
+  g_filter.transmit_epsilon = kbits(addr[5]);
+  g_filter.refresh_interval = addr[6];
 
   delay_remaining = g_filter.transmission_delay;
+  refresh_remaining = 1;  // The first transmission is always a full one
   io_printf(IO_BUF, "[Filter] transmission delay = %d\n", delay_remaining);
+  io_printf(IO_BUF, "[Filter] transmit epsilon = %k, refresh every %d\n",
+            g_filter.transmit_epsilon, g_filter.refresh_interval);
 
   g_filter.input = input_filter_initialise(&g_input, g_filter.size_in);
+  MALLOC_FAIL_FALSE(g_filter.last_output, g_filter.size_out * sizeof(value_t));
 
   if (g_filter.input == NULL)
     return false;
@@ -67,6 +136,70 @@ bool data_get_output_keys(address_t addr) {
 }
 
 bool data_get_transform(address_t addr) {
+  /* Scan the dense matrix (still in SDRAM) to pick a storage format:
+   * diagonal if square with no off-diagonal entries, compressed sparse
+   * rows if mostly zero, dense otherwise.
+   */
+  value_t *dense = (value_t *) addr;
+  uint n_elements = g_filter.size_in * g_filter.size_out;
+  uint n_nonzero = 0;
+  bool diagonal = (g_filter.size_in == g_filter.size_out);
+
+  for (uint i = 0; i < g_filter.size_out; i++) {
+    for (uint j = 0; j < g_filter.size_in; j++) {
+      if (dense[i*g_filter.size_in + j] != 0.0k) {
+        n_nonzero++;
+        if (i != j) {
+          diagonal = false;
+        }
+      }
+    }
+  }
+
+  if (diagonal) {
+    g_filter.transform_format = TRANSFORM_DIAGONAL;
+    MALLOC_FAIL_FALSE(g_filter.transform,
+                      g_filter.size_out * sizeof(value_t));
+
+    io_printf(IO_BUF, "Diagonal transform = [");
+    for (uint i = 0; i < g_filter.size_out; i++) {
+      g_filter.transform[i] = dense[i*g_filter.size_in + i];
+      io_printf(IO_BUF, "%k ", g_filter.transform[i]);
+    }
+    io_printf(IO_BUF, "]\n");
+
+    return true;
+  }
+
+  // Sparse storage costs one value and one index per nonzero plus the row
+  // pointers; use it when that beats the dense matrix
+  if (2 * n_nonzero + g_filter.size_out + 1 < n_elements) {
+    g_filter.transform_format = TRANSFORM_SPARSE;
+    MALLOC_FAIL_FALSE(g_filter.transform, n_nonzero * sizeof(value_t));
+    MALLOC_FAIL_FALSE(g_filter.sparse_cols, n_nonzero * sizeof(uint));
+    MALLOC_FAIL_FALSE(g_filter.sparse_row_ptr,
+                      (g_filter.size_out + 1) * sizeof(uint));
+
+    uint n = 0;
+    for (uint i = 0; i < g_filter.size_out; i++) {
+      g_filter.sparse_row_ptr[i] = n;
+      for (uint j = 0; j < g_filter.size_in; j++) {
+        if (dense[i*g_filter.size_in + j] != 0.0k) {
+          g_filter.transform[n] = dense[i*g_filter.size_in + j];
+          g_filter.sparse_cols[n] = j;
+          n++;
+        }
+      }
+    }
+    g_filter.sparse_row_ptr[g_filter.size_out] = n;
+
+    io_printf(IO_BUF, "Sparse transform: %d of %d entries nonzero\n",
+              n_nonzero, n_elements);
+
+    return true;
+  }
+
+  g_filter.transform_format = TRANSFORM_DENSE;
   MALLOC_FAIL_FALSE(g_filter.transform,
                     sizeof(value_t) * g_filter.size_in * g_filter.size_out);
 
@@ -85,13 +218,18 @@ bool data_get_transform(address_t addr) {
   return true;
 }
 
-void mcpl_callback(uint key, uint payload) {
-  input_filter_mcpl_rx(&g_input, key, payload);
+hot_fn void mcpl_callback(uint key, uint payload) {
+  // Defer routing work out of interrupt context until the next tick
+  if (!packet_queue_push(&g_packet_queue, key, payload) &&
+      g_packet_queue.dropped == 1) {
+    io_printf(IO_BUF, "[Filter] Packet queue full, dropping packets.\n");
+  }
 }
 
 void c_main(void) {
   address_t address = system_load_sram();
-  if (!data_system(region_start(1, address)) ||
+  if (!packet_queue_initialise(&g_packet_queue, 512) ||
+      !data_system(region_start(1, address)) ||
       !data_get_output_keys(region_start(2, address)) ||
       !input_filter_get_filters(&g_input, region_start(3, address)) ||
       !input_filter_get_filter_routes(&g_input, region_start(4, address)) ||
@@ -106,7 +244,15 @@ void c_main(void) {
     system_lead_app_configured();
   }
 
+  // Set up paced transmission of the output
+  if (!tx_scheduler_initialise(2 * g_filter.size_out + 1,
+                               g_filter.interpacket_pause)) {
+    io_printf(IO_BUF, "[Filter] Failed to initialise.\n");
+    return;
+  }
+
   // Setup timer tick, start
+  profiler_init();
   spin1_set_timer_tick(g_filter.machine_timestep);
   spin1_callback_on(MCPL_PACKET_RECEIVED, mcpl_callback, -1);
   spin1_callback_on(TIMER_TICK, filter_update, 2);
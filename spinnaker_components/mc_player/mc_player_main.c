@@ -1,6 +1,7 @@
 #include "spin1_api.h"
 #include "nengo-common.h"
 #include "common-impl.h"
+#include "init_dma.h"
 
 typedef struct _mc_packet_t {
   uint timestamp;
@@ -9,8 +10,26 @@ typedef struct _mc_packet_t {
   uint with_payload;
 } mc_packet_t;
 
+//! Packets fetched from SDRAM per chunk of the timed packet stream
+#define MC_PLAYER_CHUNK 256
+
 uint *start_packets, *end_packets;
 
+/* Timed packet playback.  The timed packet region (sorted by timestamp on
+ * the host) stays in SDRAM and is streamed through two DTCM chunk
+ * buffers, so stimulus scripts with hundreds of thousands of packets
+ * never exhaust DTCM.  Timestamps are in timer ticks.
+ */
+mc_packet_t *timed_sdram;      //!< Timed packet list in SDRAM
+uint n_timed;                  //!< Number of timed packets
+mc_packet_t *chunks[2];        //!< Ping-pong chunk buffers
+uint current_chunk;            //!< Chunk currently being played
+uint chunk_base;               //!< Index of the current chunk's first packet
+uint consume;                  //!< Next packet within the current chunk
+uint next_base;                //!< First packet of the prefetched chunk
+bool next_pending;             //!< A prefetch DMA has been issued
+volatile bool next_ready;      //!< The prefetched chunk has arrived
+
 void transmit_packet_region(uint* packets_region) {
   // Transmit each packet in turn
   mc_packet_t *packets = (mc_packet_t *) (&packets_region[1]);
@@ -23,6 +42,46 @@ void transmit_packet_region(uint* packets_region) {
   }
 }
 
+//! Start the DMA of the next chunk of timed packets, if there is one
+void maybe_prefetch(void) {
+  if (!next_pending && chunk_base + MC_PLAYER_CHUNK < n_timed) {
+    next_base = chunk_base + MC_PLAYER_CHUNK;
+
+    uint n_fetch = n_timed - next_base;
+    if (n_fetch > MC_PLAYER_CHUNK) {
+      n_fetch = MC_PLAYER_CHUNK;
+    }
+
+    next_pending = true;
+    next_ready = false;
+    spin1_dma_transfer(0, &timed_sdram[next_base],
+                       chunks[current_chunk ^ 1], DMA_READ,
+                       n_fetch * sizeof(mc_packet_t));
+  }
+}
+
+void dma_complete(uint arg0, uint arg1) {
+  use(arg0);
+  use(arg1);
+  next_ready = true;
+}
+
+//! Swap to the prefetched chunk, stalling in the (rare) case that its
+//! DMA has not yet finished
+void advance_chunk(void) {
+  maybe_prefetch();
+  while (!next_ready) {
+    continue;
+  }
+
+  current_chunk ^= 1;
+  chunk_base = next_base;
+  consume = 0;
+  next_pending = false;
+  next_ready = false;
+  maybe_prefetch();
+}
+
 void tick(uint ticks, uint arg1) {
   use(arg1);
 
@@ -30,7 +89,25 @@ void tick(uint ticks, uint arg1) {
     // Transmit all packets assigned to be sent after the end of the simulation
     transmit_packet_region(end_packets);
     spin1_exit(0);
+    return;
   }
+
+  // Inject the timed packets due this tick
+  while (chunk_base + consume < n_timed) {
+    if (consume == MC_PLAYER_CHUNK) {
+      advance_chunk();
+    }
+
+    mc_packet_t *packet = &chunks[current_chunk][consume];
+    if (packet->timestamp > ticks) {
+      break;
+    }
+
+    spin1_send_mc_packet(packet->key, packet->payload, packet->with_payload);
+    consume++;
+  }
+
+  maybe_prefetch();
 }
 
 bool get_packets(address_t source, uint** dest) {
@@ -54,6 +131,35 @@ bool get_packets(address_t source, uint** dest) {
   return true;
 }
 
+//! Prepare the streamed playback of the timed packet region
+bool get_timed_packets(address_t source) {
+  n_timed = source[0];
+  timed_sdram = (mc_packet_t *) (&source[1]);
+
+  io_printf(IO_BUF, "%d timed packets.\n", n_timed);
+
+  if (n_timed == 0) {
+    return true;
+  }
+
+  for (uint c = 0; c < 2; c++) {
+    MALLOC_FAIL_FALSE(chunks[c], MC_PLAYER_CHUNK * sizeof(mc_packet_t));
+  }
+
+  // Load the first chunk; the second is prefetched from the tick callback
+  uint n_fetch = (n_timed < MC_PLAYER_CHUNK) ? n_timed : MC_PLAYER_CHUNK;
+  init_dma_copy(chunks[0], timed_sdram, n_fetch * sizeof(mc_packet_t));
+  init_dma_barrier();
+
+  current_chunk = 0;
+  chunk_base = 0;
+  consume = 0;
+  next_pending = false;
+  next_ready = false;
+
+  return true;
+}
+
 void c_main(void) {
   // Load in all data
   address_t address = system_load_sram();
@@ -61,6 +167,7 @@ void c_main(void) {
     system_lead_app_configured();
   }
   if (!get_packets(region_start(2, address), &start_packets) ||
+      !get_timed_packets(region_start(3, address)) ||
       !get_packets(region_start(4, address), &end_packets)
   ) {
     return;
@@ -72,6 +179,7 @@ void c_main(void) {
 
   spin1_set_timer_tick(1000);
   spin1_callback_on(TIMER_TICK, tick, 2);
+  spin1_callback_on(DMA_TRANSFER_DONE, dma_complete, 0);
 
   // Synchronise with the simulation
   spin1_start(SYNC_WAIT);
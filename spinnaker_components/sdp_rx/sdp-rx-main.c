@@ -7,33 +7,82 @@ sdp_rx_parameters_t g_sdp_rx;
 void sdp_rx_tick(uint ticks, uint arg1) {
   use(arg1);
   if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    if (g_sdp_rx.frames_dropped > 0) {
+      io_printf(IO_BUF, "[SDP Rx] %d buffered frames dropped.\n",
+                g_sdp_rx.frames_dropped);
+    }
     spin1_exit(0);
   }
 
+  // Play out the next buffered frame, if any
+  if (g_sdp_rx.frame_head != g_sdp_rx.frame_tail) {
+    spin1_memcpy(g_sdp_rx.output,
+                 &g_sdp_rx.frames[g_sdp_rx.frame_head *
+                                  g_sdp_rx.n_dimensions],
+                 g_sdp_rx.n_dimensions * sizeof(value_t));
+    g_sdp_rx.frame_head = (g_sdp_rx.frame_head + 1) % SDP_RX_FRAME_QUEUE;
+    for (uint d = 0; d < g_sdp_rx.n_dimensions; d++) {
+      g_sdp_rx.fresh[d] = true;
+    }
+  }
+
   for (uint d = 0; d < g_sdp_rx.n_dimensions; d++) {
     if (g_sdp_rx.fresh[d]) {
-      spin1_send_mc_packet(g_sdp_rx.keys[d],
-                           bitsk(g_sdp_rx.output[d]),
-                           WITH_PAYLOAD);
+      tx_scheduler_send(g_sdp_rx.keys[d], bitsk(g_sdp_rx.output[d]));
       g_sdp_rx.fresh[d] = false;
-
-      spin1_delay_us(1);
     }
   }
 }
 
 /** \brief Receive packed data packed in SDP message
+ *
+ * The format of the attached data is given by cmd_rc, see SDP_RX_CMD_*.
  */
 void sdp_received(uint mailbox, uint port) {
   use(port);
   sdp_msg_t *message = (sdp_msg_t*) mailbox;
-
-  // Copy the data into the output buffer
-  // Mark values as being fresh
-  value_t * data = (value_t*) message->data;
-  for (uint d = 0; d < g_sdp_rx.n_dimensions; d++) {
-    g_sdp_rx.output[d] = data[d];
-    g_sdp_rx.fresh[d] = true;
+  uint *data = (uint *) message->data;
+
+  switch (message->cmd_rc) {
+    case SDP_RX_CMD_FRAME:
+      // One full vector: copy into the output buffer, mark all fresh
+      for (uint d = 0; d < g_sdp_rx.n_dimensions; d++) {
+        g_sdp_rx.output[d] = kbits(data[d]);
+        g_sdp_rx.fresh[d] = true;
+      }
+      break;
+
+    case SDP_RX_CMD_DELTAS:
+      // arg1 (index, value) pairs: update only the named dimensions
+      for (uint p = 0; p < message->arg1; p++) {
+        uint d = data[2 * p];
+        if (d < g_sdp_rx.n_dimensions) {
+          g_sdp_rx.output[d] = kbits(data[2 * p + 1]);
+          g_sdp_rx.fresh[d] = true;
+        }
+      }
+      break;
+
+    case SDP_RX_CMD_FRAMES:
+      // arg1 consecutive full vectors: queue for playback, one per period
+      for (uint f = 0; f < message->arg1; f++) {
+        uint next_tail = (g_sdp_rx.frame_tail + 1) % SDP_RX_FRAME_QUEUE;
+        if (next_tail == g_sdp_rx.frame_head) {
+          g_sdp_rx.frames_dropped++;
+          continue;
+        }
+        spin1_memcpy(&g_sdp_rx.frames[g_sdp_rx.frame_tail *
+                                      g_sdp_rx.n_dimensions],
+                     &data[f * g_sdp_rx.n_dimensions],
+                     g_sdp_rx.n_dimensions * sizeof(value_t));
+        g_sdp_rx.frame_tail = next_tail;
+      }
+      break;
+
+    default:
+      io_printf(IO_BUF, "[SDP Rx] Unknown message format %d\n",
+                message->cmd_rc);
+      break;
   }
   spin1_msg_free(message);
 }
@@ -43,14 +92,23 @@ void sdp_received(uint mailbox, uint port) {
 bool data_system(address_t addr) {
   g_sdp_rx.transmission_period = addr[0];
   g_sdp_rx.n_dimensions = addr[1];
+  g_sdp_rx.dimension_offset = addr[2];
 
   io_printf(IO_BUF, "[SDP Rx] Transmission period: %d\n",
             g_sdp_rx.transmission_period);
-  io_printf(IO_BUF, "[SDP Rx] %d dimensions.\n", g_sdp_rx.n_dimensions);
+  io_printf(IO_BUF, "[SDP Rx] Dimensions [%d, %d).\n",
+            g_sdp_rx.dimension_offset,
+            g_sdp_rx.dimension_offset + g_sdp_rx.n_dimensions);
 
   MALLOC_FAIL_FALSE(g_sdp_rx.output, g_sdp_rx.n_dimensions * sizeof(value_t));
   MALLOC_FAIL_FALSE(g_sdp_rx.fresh, g_sdp_rx.n_dimensions * sizeof(bool));
   MALLOC_FAIL_FALSE(g_sdp_rx.keys, g_sdp_rx.n_dimensions * sizeof(uint));
+  MALLOC_FAIL_FALSE(g_sdp_rx.frames, SDP_RX_FRAME_QUEUE *
+                    g_sdp_rx.n_dimensions * sizeof(value_t));
+
+  g_sdp_rx.frame_head = 0;
+  g_sdp_rx.frame_tail = 0;
+  g_sdp_rx.frames_dropped = 0;
 
   return true;
 }
@@ -88,6 +146,12 @@ void c_main(void) {
     system_lead_app_configured();
   }
 
+  // Set up paced transmission of the cached values
+  if (!tx_scheduler_initialise(2 * g_sdp_rx.n_dimensions + 1, 1)) {
+    io_printf(IO_BUF, "[Rx] Failed to initialise.\n");
+    return;
+  }
+
   // Setup timer tick, start
   spin1_set_timer_tick(g_sdp_rx.transmission_period);
   spin1_callback_on(SDP_PACKET_RX, sdp_received, -1);
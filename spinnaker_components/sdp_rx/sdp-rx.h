@@ -4,6 +4,13 @@
  *        caches the attached data and transmits the values with preloaded
  *        keys at a defined interval.
  *
+ * Wide external inputs are sharded across several cores: each instance
+ * is configured with an (offset, count) slice of the dimension space and
+ * carries only the output keys of its slice.  All message indices and
+ * data are slice-relative; the host addresses each core with its own
+ * slice of the full vector, so the cores receive and transmit in
+ * parallel.
+ *
  * \copyright Advanced Processor Technologies, School of Computer Science,
  *   University of Manchester
  * \copyright Computational Neuroscience Research Group, Centre for
@@ -18,18 +25,41 @@
 #include "common-impl.h"
 #include "nengo-common.h"
 #include "nengo_typedefs.h"
+#include "tx_scheduler.h"
+
+/* SDP message formats, discriminated on cmd_rc:
+ *  - SDP_RX_CMD_FRAME:  data holds one full n_dimensions vector; every
+ *    dimension is marked fresh.
+ *  - SDP_RX_CMD_DELTAS: arg1 holds a pair count, data holds (index, value)
+ *    word pairs; only the named dimensions are updated and marked fresh.
+ *  - SDP_RX_CMD_FRAMES: arg1 holds a frame count, data holds that many
+ *    consecutive full vectors, which are queued and played out one per
+ *    transmission period.
+ */
+#define SDP_RX_CMD_FRAME  1
+#define SDP_RX_CMD_DELTAS 2
+#define SDP_RX_CMD_FRAMES 3
+
+//! Depth of the multi-frame input queue / frames
+#define SDP_RX_FRAME_QUEUE 8
 
 /** \brief Shared Rx parameters.
  */
 typedef struct sdp_rx_parameters {
   uint transmission_period; //!< Microsecond period between output values
 
-  uint n_dimensions;        //!< Number of dimensions represented
+  uint n_dimensions;        //!< Number of dimensions in this core's slice
+  uint dimension_offset;    //!< First dimension of this core's slice
   uint current_dimension;   //!< Index of the currently selected dimension
 
   value_t *output;          //!< Currently cached output value
   bool *fresh;              //!< Freshness of output
   uint *keys;               //!< Output keys
+
+  value_t *frames;          //!< Queue of buffered input frames
+  uint frame_head;          //!< Next frame to play out
+  uint frame_tail;          //!< Next free frame
+  uint frames_dropped;      //!< Frames discarded because the queue was full
 } sdp_rx_parameters_t;
 extern sdp_rx_parameters_t g_sdp_rx; //!< Global parameters
 
@@ -15,6 +15,7 @@
 
 #include "spin1_api.h"
 #include "input_filter.h"
+#include "profiler.h"
 
 #include "common-impl.h"
 
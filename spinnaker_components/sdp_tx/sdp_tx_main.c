@@ -4,37 +4,60 @@ sdp_tx_parameters_t g_sdp_tx;
 uint delay_remaining;
 input_filter_t g_input;
 
-void sdp_tx_update(uint ticks, uint arg1) {
+sdp_msg_t g_message;        //!< Pre-built output message
+bool send_pending;          //!< A transmission is awaiting a free Tx buffer
+uint dropped_messages;      //!< Transmissions superseded before being sent
+
+/** \brief Attempt to send the output message without blocking.
+ *
+ * The filters accumulate directly into the message payload, so a retry
+ * always carries the latest filtered values.
+ */
+static void try_send(void) {
+  if (spin1_send_sdp_msg(&g_message, 0)) {
+    send_pending = false;
+  }
+}
+
+hot_fn void sdp_tx_update(uint ticks, uint arg1) {
   use(arg1);
   if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    if (dropped_messages > 0) {
+      io_printf(IO_BUF, "[SDP Tx] %d output messages dropped.\n",
+                dropped_messages);
+    }
+    sark.vcpu->user2 = dropped_messages;
+    profiler_finalise();
     spin1_exit(0);
   }
 
   // Update the filters
+  profiler_start(PROFILER_PHASE_INPUT);
   input_filter_step(&g_input, true);
+  profiler_end(PROFILER_PHASE_INPUT);
+
+  // Retry a transmission which found no free Tx buffer last tick
+  if (send_pending) {
+    try_send();
+  }
 
   // Increment the counter and transmit if necessary
   delay_remaining--;
   if(delay_remaining == 0) {
     delay_remaining = g_sdp_tx.transmission_delay;
-
-    // Construct and transmit the SDP Message
-    sdp_msg_t message;
-    message.dest_addr = 0x0000;        // (0, 0)
-    message.dest_port = 0xff;
-    message.srce_addr = sv->p2p_addr;  // Sender P2P address
-    message.srce_port = spin1_get_id();
-    message.flags = 0x07;              // No reply expected
-    message.tag = 1;                   // Send to IPtag 1
-
-    message.cmd_rc = 1;
-    spin1_memcpy(
-      message.data, g_sdp_tx.input, g_sdp_tx.n_dimensions * sizeof(value_t));
-
-    message.length = sizeof(sdp_hdr_t) + sizeof(cmd_hdr_t) + 
-                     g_sdp_tx.n_dimensions * sizeof(value_t);
-
-    spin1_send_sdp_msg(&message, 100);
+    profiler_start(PROFILER_PHASE_TRANSMIT);
+
+    /* The message header was built at initialisation and the filters
+     * accumulate directly into its payload: just send.  A failed send is
+     * retried on subsequent ticks; if it is still pending when the next
+     * transmission falls due the earlier message is counted as dropped.
+     */
+    if (send_pending) {
+      dropped_messages++;
+    }
+    send_pending = true;
+    try_send();
+    profiler_end(PROFILER_PHASE_TRANSMIT);
   }
 }
 
@@ -48,14 +71,30 @@ bool data_system(address_t addr) {
             g_sdp_tx.machine_timestep);
   io_printf(IO_BUF, "[SDP Tx] transmission delay = %d\n", delay_remaining);
 
-  g_sdp_tx.input = input_filter_initialise(&g_input, g_sdp_tx.n_dimensions);
+  // Build the output message once; only its payload changes thereafter
+  g_message.dest_addr = 0x0000;        // (0, 0)
+  g_message.dest_port = 0xff;
+  g_message.srce_addr = sv->p2p_addr;  // Sender P2P address
+  g_message.srce_port = spin1_get_id();
+  g_message.flags = 0x07;              // No reply expected
+  g_message.tag = 1;                   // Send to IPtag 1
+  g_message.cmd_rc = 1;
+  g_message.length = sizeof(sdp_hdr_t) + sizeof(cmd_hdr_t) +
+                     g_sdp_tx.n_dimensions * sizeof(value_t);
+
+  send_pending = false;
+  dropped_messages = 0;
+
+  // The filters accumulate directly into the message payload
+  g_sdp_tx.input = input_filter_initialise_with_accumulator(
+      &g_input, g_sdp_tx.n_dimensions, (value_t *) g_message.data);
 
   if (g_sdp_tx.input == NULL)
     return false;
   return true;
 }
 
-void mcpl_callback(uint key, uint payload) {
+hot_fn void mcpl_callback(uint key, uint payload) {
   input_filter_mcpl_rx(&g_input, key, payload);
 }
 
@@ -75,6 +114,7 @@ void c_main(void) {
   }
 
   // Setup timer tick, start
+  profiler_init();
   spin1_set_timer_tick(g_sdp_tx.machine_timestep);
   spin1_callback_on(MCPL_PACKET_RECEIVED, mcpl_callback, -1);
   spin1_callback_on(TIMER_TICK, sdp_tx_update, 2);
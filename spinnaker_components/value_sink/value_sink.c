@@ -6,16 +6,43 @@ value_t *input;
 
 input_filter_t g_input;
 
+/* Frames are staged in DTCM and flushed to SDRAM as one DMA burst every
+ * `staging_frames` ticks, rather than as a blocking memcpy per tick.  Two
+ * staging buffers alternate so a flush can overlap the following ticks.
+ */
+value_t *staging[2];   //!< Ping-pong staging buffers
+uint staging_frames;   //!< Frames per staging buffer
+uint current_staging;  //!< Buffer currently being filled
+uint frames_buffered;  //!< Frames in the current buffer
+
+void sink_flush(uint n_frames) {
+  if (n_frames > 0) {
+    spin1_dma_transfer(0, rec_curr, staging[current_staging], DMA_WRITE,
+                       n_frames * n_dimensions * sizeof(value_t));
+    rec_curr = &rec_curr[n_frames * n_dimensions];
+    current_staging ^= 1;
+    frames_buffered = 0;
+  }
+}
+
 void sink_update(uint ticks, uint arg1) {
   use(arg1);
   if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    // Flush any partially filled staging buffer before exiting
+    sink_flush(frames_buffered);
     spin1_exit(0);
   }
 
-  // Filter inputs, write the latest value to SRAM
+  // Filter inputs, stage the latest value
   input_filter_step(&g_input, true);
-  spin1_memcpy(rec_curr, input, n_dimensions * sizeof(value_t));
-  rec_curr = &rec_curr[n_dimensions];
+  spin1_memcpy(&staging[current_staging][frames_buffered * n_dimensions],
+               input, n_dimensions * sizeof(value_t));
+  frames_buffered++;
+
+  // Flush the staging buffer to SDRAM as a single burst when full
+  if (frames_buffered == staging_frames) {
+    sink_flush(staging_frames);
+  }
 }
 
 void mcpl_callback(uint key, uint payload) {
@@ -47,6 +74,24 @@ void c_main(void)
   }
   rec_start = rec_curr = region_start(15, address);
 
+  // Size the staging buffers to the batch budget (at least one frame each)
+  staging_frames = SINK_BATCH_BYTES / (n_dimensions * sizeof(value_t));
+  if (staging_frames == 0) {
+    staging_frames = 1;
+  }
+  for (uint b = 0; b < 2; b++) {
+    if (NULL == (staging[b] = nengo_malloc(
+          staging_frames * n_dimensions * sizeof(value_t)))) {
+      io_printf(IO_BUF, "[Value Sink] Failed to malloc staging buffer.\n");
+      return;
+    }
+  }
+  current_staging = 0;
+  frames_buffered = 0;
+
+  io_printf(IO_BUF, "[Value Sink] Batching %d frames per SDRAM write.\n",
+            staging_frames);
+
   // Set up callbacks, start
   spin1_set_timer_tick(pars->timestep);
   spin1_callback_on(MCPL_PACKET_RECEIVED, mcpl_callback, -1);
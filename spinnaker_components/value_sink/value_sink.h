@@ -6,6 +6,9 @@
 
 #include "input_filter.h"
 
+//! Size (bytes) of each of the two DTCM frame staging buffers
+#define SINK_BATCH_BYTES (4 * 1024)
+
 typedef struct _region_system_t {
   uint timestep;
   uint n_dimensions;
@@ -1,41 +1,57 @@
 #ifndef __SLOTS_H__
 #define __SLOTS_H__
 
+/* Number of slots in the ring.  More slots means more blocks buffered
+ * ahead of the output and so more tolerance of delayed DMAs under SDRAM
+ * contention; each slot gets an equal share of the buffer budget, so more
+ * slots also means smaller blocks and more frequent DMA requests.
+ */
+#ifndef VALUE_SOURCE_N_SLOTS
+#define VALUE_SOURCE_N_SLOTS 4
+#endif
+
+// Slot states
+#define SLOT_FREE 0     //!< Empty, available for a prefetch
+#define SLOT_PENDING 1  //!< DMA in flight
+#define SLOT_READY 2    //!< Filled, awaiting consumption
+
 typedef struct __slot_t {
   uint* data;
   uint current_pos;
   uint length;
+  volatile uchar state;  //!< One of SLOT_FREE / SLOT_PENDING / SLOT_READY
 } _slot_t;
 
+/* A ring of slots.  Blocks are DMAed into consecutive slots as soon as
+ * they free up (slot `fill` next); DMAs complete in issue order, readying
+ * consecutive slots (slot `complete` next); frames are transmitted from
+ * slot `consume` until it empties.
+ */
 typedef struct _slots_t {
-  _slot_t* current; //!< The current slot
-  _slot_t* next;    //!< The next slot
+  uint consume;   //!< Slot currently being consumed
+  uint fill;      //!< Next slot to start filling
+  uint complete;  //!< Next slot whose DMA will complete
 
-  _slot_t slots[2];
+  _slot_t slots[VALUE_SOURCE_N_SLOTS];
 } slots_t;
 
 static inline bool initialise_slots(slots_t* slots, uint size) {
-  // Initialise the slots with the given size
-  for (uint i = 0; i < 2; i++) {
-    MALLOC_FAIL_FALSE(slots->slots[i].data, size);
+  // Initialise the slots, dividing the buffer budget equally between them
+  for (uint i = 0; i < VALUE_SOURCE_N_SLOTS; i++) {
+    MALLOC_FAIL_FALSE(slots->slots[i].data, size / VALUE_SOURCE_N_SLOTS);
     slots->slots[i].current_pos = 0;
     slots->slots[i].length = 0;
+    slots->slots[i].state = SLOT_FREE;
   }
 
-  slots->current = &slots->slots[0];
-  slots->next = &slots->slots[1];
+  slots->consume = 0;
+  slots->fill = 0;
+  slots->complete = 0;
   return true;
 }
 
-static inline void slots_progress(slots_t* slots) {
-  // Swap the slots pointers
-  _slot_t* t = slots->next;
-  slots->next = slots->current;
-  slots->current = t;
-
-  // Clear the new next slot
-  slots->next->length = 0;
-  slots->next->current_pos = 0;
+static inline uint slots_next(uint i) {
+  return (i + 1 == VALUE_SOURCE_N_SLOTS) ? 0 : i + 1;
 }
 
 #endif
@@ -1,86 +1,107 @@
 #include "value_source.h"
 #include "slots.h"
+#include "init_dma.h"
 
-slots_t slots;            // Slots for output data
+slots_t slots;            // Slot ring for output data
 uint* keys;               // Output keys
 system_parameters_t pars; // Global system parameters
 uint n_blocks;            // Number of blocks (in total)
-uint current_block;       // Current block
+uint fill_block;          // Next block to prefetch
+uint blocks_consumed;     // Number of blocks fully transmitted
+uint underrun_count;      // Ticks with no block ready to transmit
 void* blocks;             // Location of blocks in DRAM
 
+//! Length in frames of the given block
+static uint block_frames(uint block) {
+  return (block < pars.n_blocks) ? pars.block_length : pars.partial_block;
+}
+
+/* Start DMAs for as many upcoming blocks as there are free slots.  Called
+ * whenever a slot may have freed; the spin1 API queues the requests so
+ * several may be in flight at once.
+ */
+static void prefetch_blocks(void) {
+  while (slots.slots[slots.fill].state == SLOT_FREE) {
+    if (fill_block == n_blocks) {
+      if (!(pars.flags & 0x1)) {
+        // Aperiodic: nothing more to fetch
+        return;
+      }
+      // Periodic: wrap to the first block
+      fill_block = 0;
+    }
+
+    _slot_t *slot = &slots.slots[slots.fill];
+    void *s_addr = &blocks[fill_block * pars.block_length *
+                           pars.n_dims * sizeof(value_t)];
+
+    slot->length = block_frames(fill_block);
+    slot->current_pos = 0;
+    slot->state = SLOT_PENDING;
+    spin1_dma_transfer(0, s_addr, slot->data, DMA_READ,
+                       slot->length * pars.n_dims * sizeof(value_t));
+
+    slots.fill = slots_next(slots.fill);
+    fill_block++;
+  }
+}
+
+//! DMA complete: DMAs finish in issue order, so ready the next pending slot
+void dma_complete(uint arg0, uint arg1) {
+  use(arg0);
+  use(arg1);
+  slots.slots[slots.complete].state = SLOT_READY;
+  slots.complete = slots_next(slots.complete);
+}
+
 void valsource_tick(uint ticks, uint arg1) {
   use(arg1);
   if (simulation_ticks != UINT32_MAX && ticks >= simulation_ticks) {
+    if (underrun_count > 0) {
+      io_printf(IO_BUF, "[Value Source] %d output frames lost to slot"
+                " underruns.\n", underrun_count);
+    }
+    sark.vcpu->user1 = underrun_count;
     spin1_exit(0);
   }
 
+  _slot_t *current = &slots.slots[slots.consume];
+  if (current->state != SLOT_READY) {
+    /* The DMA for this slot has been delayed (SDRAM contention): skip this
+     * frame rather than transmitting stale data, and count the underrun.
+     */
+    underrun_count++;
+    sark.vcpu->user1 = underrun_count;
+    prefetch_blocks();
+    return;
+  }
+
   // Transmit a MC packet for each value in the current frame
   for (uint d = 0; d < pars.n_dims; d++) {
     spin1_send_mc_packet(
         keys[d],
-        slots.current->data[slots.current->current_pos*pars.n_dims + d],
+        current->data[current->current_pos*pars.n_dims + d],
         WITH_PAYLOAD
     );
   }
 
-  // Copy in the next block
-  if (slots.current->current_pos == 0) {
-    if (n_blocks > 1) {
-      // More than one block, need to copy in subsequent block
-      void *s_addr = &blocks[(current_block + 1) * pars.block_length *
-                              pars.n_dims * sizeof(value_t)];
-
-      if (current_block == pars.n_blocks - 1) {
-        // Subsequent block is the LAST block
-        spin1_dma_transfer(0, s_addr, slots.next->data, DMA_READ,
-                           pars.partial_block * pars.n_dims * sizeof(value_t));
-        slots.next->length = pars.partial_block;
-      } else if (current_block == pars.n_blocks) {
-        // Current block is the LAST block
-        if (pars.flags & 0x1) {
-          // We are wrapping, so next block is the FIRST block
-          spin1_dma_transfer(0, blocks, slots.next->data, DMA_READ,
-                             pars.block_length * pars.n_dims * sizeof(value_t));
-          slots.next->length = pars.block_length;
-        }
-      } else {
-        // Nothing special about subsequent block
-        spin1_dma_transfer(0, s_addr, slots.next->data, DMA_READ,
-                           pars.block_length * pars.n_dims * sizeof(value_t));
-        slots.next->length = pars.block_length;
-      }
-    }
-  }
+  // Progress, freeing the slot once its last frame has been transmitted
+  current->current_pos++;
+  if (current->current_pos == current->length) {
+    current->state = SLOT_FREE;
+    slots.consume = slots_next(slots.consume);
+    blocks_consumed++;
 
-  // Switch blocks if necessary
-  slots.current->current_pos++;
-  if (slots.current->current_pos == slots.current->length) {
-    // We've reached the end of the current slot, progress or wrap
-    if (n_blocks == 1) {
-      // Only one block: wrap or exit
-      if (pars.flags & 0x1) {
-        // Function is periodic: wrap to start
-        slots.current->current_pos = 0;
-      } else {
-        // Function is not periodic: exit
-        spin1_exit(0);
-      }
-    } else {
-      // Multiple blocks: next, wrap or exit
-      if (current_block == n_blocks - 1 && !(pars.flags & 0x1)) {
-        // Last block, aperiodic: exit
-        spin1_exit(0);
-      } else {
-        // Not last block, or periodic: next
-        slots_progress(&slots);
-        current_block++;
-
-        // Wrap if necessary
-        if (current_block == n_blocks)
-          current_block = 0;
-      }
+    if (blocks_consumed == n_blocks && !(pars.flags & 0x1)) {
+      // Last block, aperiodic: exit
+      sark.vcpu->user1 = underrun_count;
+      spin1_exit(0);
+      return;
     }
   }
+
+  // Refill any free slots
+  prefetch_blocks();
 }
 
 void c_main(void) {
@@ -92,40 +113,45 @@ void c_main(void) {
   // Copy in the system region
   spin1_memcpy(&pars, region_start(1, address), sizeof(system_parameters_t));
   n_blocks = pars.n_blocks + (pars.partial_block > 0 ? 1 : 0);
-  current_block = 0;
+  fill_block = 0;
+  blocks_consumed = 0;
+  underrun_count = 0;
   blocks = (void *) region_start(3, address);
 
   io_printf(IO_BUF, "[Value Source] %d dimensions, %d full blocks of %d FRAMES"
-                    ", PLUS %d FRAMES = %d blocks\n",
+                    ", PLUS %d FRAMES = %d blocks, %d slots\n",
             pars.n_dims, pars.n_blocks, pars.block_length, pars.partial_block,
-            n_blocks);
+            n_blocks, VALUE_SOURCE_N_SLOTS);
 
   // Make space for keys
-  keys = spin1_malloc(pars.n_dims * sizeof(uint));
+  keys = nengo_malloc(pars.n_dims * sizeof(uint));
   if (keys == NULL) {
     io_printf(IO_BUF, "Failed to malloc space for keys.\n");
     return;
   }
   spin1_memcpy(keys, region_start(2, address), pars.n_dims * sizeof(uint));
 
-  // Initialise the slots with 20KB buffer space
+  // Initialise the slot ring with 20KB buffer space
   if (!initialise_slots(&slots, 20*1024)) {
     return;
   }
 
-  // Copy in the first block of data
-  if (n_blocks > 1) {
-    spin1_memcpy(slots.current->data, region_start(3, address),
-                 pars.n_dims * pars.block_length * sizeof(value_t));
-    slots.current->length = pars.block_length;
-  } else {
-    spin1_memcpy(slots.current->data, region_start(3, address),
-                 pars.n_dims * pars.partial_block * sizeof(value_t));
-    slots.current->length = pars.partial_block;
-  }
+  // Copy in the first block of data, then mark the remaining slots for
+  // prefetch once the timer starts
+  init_dma_copy(slots.slots[0].data, region_start(3, address),
+                pars.n_dims * block_frames(0) * sizeof(value_t));
+  slots.slots[0].length = block_frames(0);
+  slots.slots[0].state = SLOT_READY;
+  slots.fill = 1;
+  slots.complete = 1;
+  fill_block = 1;
+
+  // Wait for the first block before starting
+  init_dma_barrier();
 
   // Set up callbacks, wait for synchronisation
   spin1_set_timer_tick(pars.time_step);
   spin1_callback_on(TIMER_TICK, valsource_tick, 0);
+  spin1_callback_on(DMA_TRANSFER_DONE, dma_complete, 0);
   spin1_start(SYNC_WAIT);
 }